@@ -0,0 +1,252 @@
+/*
+ * File:   bench.cpp
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:26
+ *
+ * Benchmarks of the hot paths of the menu: navigation, edition, rendering and
+ * float formatting, run on synthetic menus. Prints the time per operation and
+ * the heap allocations done, to track regressions between releases.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "menu_controller.h"
+#include "menu_index.h"
+#include "synthetic_menu.h"
+#include "value_registry.h"
+
+using namespace std;
+
+//=============================================================================
+// Allocation counting
+//=============================================================================
+
+static size_t allocations = 0;
+
+void* operator new(size_t sz) {
+    allocations++;
+    void* p = malloc(sz);
+    if (!p)
+        throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+//=============================================================================
+// Synthetic menus
+//=============================================================================
+
+static volatile char sink;
+
+/** Chain of sections as deep as the menu allows, with a couple of values each */
+typedef SyntheticMenu<MAX_MENU_DEPTH, 1, 2, SYNTHETIC_INT32 | SYNTHETIC_FLOAT32> DeepMenu;
+/** A single section with many float items */
+typedef SyntheticMenu<1, 0, 64, SYNTHETIC_FLOAT32> WideMenu;
+/** Thousands of sections with all the item types */
+typedef SyntheticMenu<4, 16, 8> BigMenu;
+
+static DeepMenu deep_menu;
+static WideMenu wide_menu;
+static BigMenu big_menu;
+static MenuIndex<40000> big_index;
+
+//=============================================================================
+// Helpers
+//=============================================================================
+
+/**
+ * Run op n times and print the time per call and the allocations done.
+ */
+template<typename F>
+void bench(const char* name, uint32_t n, F op) {
+    size_t allocs = allocations;
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n; i++)
+        op(i);
+    auto end = chrono::steady_clock::now();
+    double ns = chrono::duration<double, nano>(end - start).count() / n;
+    cout.width(28);
+    cout << left << name;
+    cout.width(10);
+    cout << right << fixed;
+    cout.precision(1);
+    cout << ns << " ns/op";
+    cout.width(8);
+    cout << allocations - allocs << " allocs" << endl;
+}
+
+//=============================================================================
+// Benchmarks
+//=============================================================================
+
+void benchNavigation() {
+    MenuController wide_ctrl(wide_menu);
+    bench("down (wide section)", 1000000, [&](uint32_t) { wide_ctrl.down(); });
+    bench("up (wide section)", 1000000, [&](uint32_t) { wide_ctrl.up(); });
+    bench("pageDown (wide section)", 1000000, [&](uint32_t i) {
+        if ((i & 31) == 31)
+            wide_ctrl.home();
+        else
+            wide_ctrl.pageDown();
+    });
+    bench("seek (wide section)", 1000000, [&](uint32_t i) { wide_ctrl.seek(i & 63); });
+    // an encoder spin of 16 detents, one by one and as a batch
+    bench("16 x down (wide section)", 100000, [&](uint32_t) {
+        for (uint8_t i = 0; i < 16; i++)
+            wide_ctrl.down();
+    });
+    MenuEventQueue<32> queue;
+    bench("processEvents 16 downs", 100000, [&](uint32_t) {
+        for (uint8_t i = 0; i < 16; i++)
+            queue.push(MenuAction::DOWN);
+        wide_ctrl.processEvents(queue);
+    });
+}
+
+void benchScrolling() {
+    ScrollMenuController wide_ctrl(wide_menu);
+    bench("down (wide, scroll)", 1000000, [&](uint32_t) { wide_ctrl.down(); });
+    bench("up (wide, scroll)", 1000000, [&](uint32_t) { wide_ctrl.up(); });
+
+}
+
+void benchSections() {
+    MenuController deep_ctrl(deep_menu);
+    // enter walks the chain of sections down to the leaf, then escape goes
+    // back to the root
+    bench("enter (deep menu)", 100000, [&](uint32_t) {
+        if (deep_ctrl.getPath().level == MAX_MENU_DEPTH - 1) {
+            while (deep_ctrl.getPath().level > 0)
+                deep_ctrl.escape();
+        }
+        deep_ctrl.enter();
+    });
+    bench("enter + escape (deep menu)", 100000, [&](uint32_t) {
+        deep_ctrl.enter();
+        deep_ctrl.escape();
+    });
+
+    // built while no controller holds the only slot of the arena
+    bench("index build (big menu)", 1, [&](uint32_t) { big_index.build(big_menu); });
+    MenuController big_ctrl(big_menu);
+    bench("find + seek (big menu)", 10000, [&](uint32_t i) {
+        // alternate between a shallow item and one of the deepest, the last
+        uint16_t found = big_index.find("Bool", (i & 1) ? big_index.getCount() - 64 : 300);
+        big_index.seek(big_ctrl, found);
+    });
+    // jump between two leaves far apart
+    MenuController::Path paths[2];
+    for (uint8_t i = 0; i < 2; i++) {
+        while (big_ctrl.getPath().level < 3) {
+            big_ctrl.seek((uint8_t)(i * 15));
+            big_ctrl.enter();
+        }
+        paths[i] = big_ctrl.getPath();
+        while (big_ctrl.getPath().level > 0)
+            big_ctrl.escape();
+    }
+    bench("seek path (big menu)", 100000, [&](uint32_t i) { big_ctrl.seek(paths[i & 1]); });
+    while (big_ctrl.getPath().level > 0)
+        big_ctrl.escape();
+    // visit the children of the root back and forth
+    bench("enter + escape (big menu)", 100000, [&](uint32_t i) {
+        big_ctrl.enter();
+        big_ctrl.escape();
+        if ((i / 15) & 1)
+            big_ctrl.up();
+        else
+            big_ctrl.down();
+    });
+}
+
+void benchEdit() {
+    MenuController ctrl(wide_menu);
+    ctrl.enter();
+    bench("changeValue (float)", 1000000, [&](uint32_t i) {
+        if (i & 1)
+            ctrl.up();
+        else
+            ctrl.down();
+    });
+    bench("moveCursor (float)", 1000000, [&](uint32_t) { ctrl.left(); });
+    ctrl.escape();
+    bench("startEdit + cancel (float)", 1000000, [&](uint32_t) {
+        ctrl.enter();
+        ctrl.escape();
+    });
+}
+
+void benchSnapshot() {
+    static ValueEntry entries[WideMenu::value_count];
+    for (uint16_t i = 0; i < WideMenu::value_count; i++)
+        entries[i] = {&wide_menu.getValue(i), i, MenuItemType::float32};
+    const ValueRegistry registry(entries);
+    static uint8_t buf[sizeof(entries) * 2];
+    bench("snapshot (64 floats)", 100000, [&](uint32_t) {
+        sink = registry.snapshot(buf, sizeof(buf));
+    });
+    size_t size = registry.snapshot(buf, sizeof(buf));
+    bench("restoreSnapshot (64 floats)", 100000, [&](uint32_t) {
+        sink = registry.restoreSnapshot(buf, size);
+    });
+}
+
+void benchRender() {
+    char buf[16];
+    for (uint16_t i = 0; i < WideMenu::value_count; i++)
+        wide_menu.getValue(i).real = i * 1.5f;
+    MenuController ctrl(wide_menu);
+    // what a GUI does for every item of a page
+    bench("getValueAsString (float)", 1000000, [&](uint32_t i) {
+        const EndpointMenuItem* item = (const EndpointMenuItem*)ctrl.getItems()[i & 63];
+        item->getValueAsString(buf, sizeof(buf));
+        sink = buf[0];
+    });
+    int32_t value = 123456;
+    Int32MenuItem integer(true, "Integer", &value, {-1000000, 1000000, 0}, 0);
+    bench("getValueAsString (int32)", 1000000, [&](uint32_t i) {
+        value = i;
+        integer.getValueAsString(buf, sizeof(buf));
+        sink = buf[0];
+    });
+}
+
+void benchFormat() {
+    char buf[16];
+    int8_t exp;
+    bench("ftoaFix", 1000000, [&](uint32_t i) {
+        ftoaFix(buf, sizeof(buf), 1.2345E2f + i, 2);
+        sink = buf[0];
+    });
+    bench("ftoaEng", 1000000, [&](uint32_t i) {
+        ftoaEng(buf, sizeof(buf), &exp, 1.02030405E4f + i, 5);
+        sink = buf[0];
+    });
+    bench("ftoaSci", 1000000, [&](uint32_t i) {
+        ftoaSci(buf, sizeof(buf), &exp, 1.2345E5f + i, 4);
+        sink = buf[0];
+    });
+}
+
+int main(int argc, char** argv) {
+    cout << "Big menu: " << BigMenu::section_count << " sections of "
+            << big_menu.getSectionBytes() << " bytes, " << sizeof(BigMenu)
+            << " bytes of factory" << endl << endl;
+    cout << "Navigation:" << endl;
+    benchNavigation();
+    benchScrolling();
+    benchSections();
+    cout << endl << "Edition:" << endl;
+    benchEdit();
+    benchSnapshot();
+    cout << endl << "Rendering:" << endl;
+    benchRender();
+    cout << endl << "Formatting:" << endl;
+    benchFormat();
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * File:   file_eeprom.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:40
+ */
+
+#ifndef FILE_EEPROM_H
+#define FILE_EEPROM_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "value_store.h"
+
+//=============================================================================
+// FileEeprom
+//=============================================================================
+
+/**
+ * EEPROM of SIZE bytes emulated on the PC with a file, for testing the
+ * ValueStore. The contents are kept in memory and saved to the file on every
+ * write, as a real EEPROM would. A missing file starts erased, i.e. filled
+ * with 0xFF.
+ *
+ * It also counts the writes of every byte, to check the wear leveling.
+ */
+template<size_t SIZE>
+class FileEeprom : public EepromDevice {
+    const char* path_;
+    uint8_t mem_[SIZE];
+    uint32_t wear_[SIZE]{0};
+    uint32_t writes_{0};
+
+    void save() {
+        FILE* file = fopen(path_, "wb");
+        if (!file)
+            return;
+        fwrite(mem_, 1, SIZE, file);
+        fclose(file);
+    }
+public:
+    FileEeprom(const char* path) : path_(path) {
+        memset(mem_, 0xFF, SIZE);
+        FILE* file = fopen(path_, "rb");
+        if (!file)
+            return;
+        size_t n = fread(mem_, 1, SIZE, file);
+        (void)n; // a short file leaves the rest erased
+        fclose(file);
+    }
+    size_t getSize() const override { return SIZE; }
+    void read(size_t addr, void* buf, size_t sz) override {
+        if (addr + sz <= SIZE)
+            memcpy(buf, mem_ + addr, sz);
+    }
+    void write(size_t addr, const void* buf, size_t sz) override {
+        if (addr + sz > SIZE)
+            return;
+        memcpy(mem_ + addr, buf, sz);
+        for (size_t i = addr; i < addr + sz; i++)
+            wear_[i]++;
+        writes_++;
+        save();
+    }
+    /** Number of write() calls */
+    uint32_t getWrites() const { return writes_; }
+    /** Highest number of writes of any byte */
+    uint32_t getMaxWear() const {
+        uint32_t max = 0;
+        for (size_t i = 0; i < SIZE; i++) {
+            if (wear_[i] > max)
+                max = wear_[i];
+        }
+        return max;
+    }
+};
+
+#endif /* FILE_EEPROM_H */
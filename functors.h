@@ -10,6 +10,8 @@
 
 // forward declaration
 class EndpointMenuItem;
+class MenuTransaction;
+struct MenuHistoryEntry;
 
 //=============================================================================
 // Functors
@@ -52,6 +54,32 @@ public:
     virtual void operator()() = 0;
 };
 
+class OnCommitF {
+public:
+    virtual ~OnCommitF() = default;
+    /**
+     * Check the new values of a transaction together, before they are set.
+     * Return false to reject them, leaving the transaction open.
+     */
+    virtual bool validate(const MenuTransaction& transaction) { return true; }
+    /** Called once after all the new values of a transaction are set */
+    virtual void operator()(const MenuTransaction& transaction) = 0;
+};
+
+/**
+ * Called for every value set by MenuController::undo() and redo(), which do
+ * not call the onEndEdit callbacks of the items.
+ */
+class OnUndoF {
+public:
+    virtual ~OnUndoF() = default;
+    /**
+     * @param entry the change, whose old value is the one set if undone, and
+     * the new value if redone
+     */
+    virtual void operator()(const MenuHistoryEntry& entry, bool undone) = 0;
+};
+
 //=============================================================================
 // NOP functors (no operation)
 //=============================================================================
@@ -80,6 +108,14 @@ public:
     void operator()(EndpointMenuItem& item) { }
 };
 
+/**
+ * Use this instance for convenience when no action is desired.
+ */
+class OnCommitNOP : public OnCommitF {
+public:
+    void operator()(const MenuTransaction& transaction) { }
+};
+
 /**
  * The way the section code works, no instance of this class is needed.
  */
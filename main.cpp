@@ -7,13 +7,28 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <string>
+#if defined(MENU_TRACE) || defined(MENU_EEPROM_FILE)
+#include <chrono>
+#endif
+#ifdef MENU_EEPROM_FILE
+#include "file_eeprom.h"
+#endif
 // #include "test_sections.h"
 #include "menu_controller.h"
+#include "menu_index.h"
 #include "menu_item.h"
 #include "test_menu.h"
 
 using namespace std;
 
+// the test uses pages by default, scrolling if MENU_NAV_SCROLL is defined
+#ifdef MENU_NAV_SCROLL
+typedef ScrollMenuController TestController;
+#else
+typedef MenuController TestController;
+#endif
+
 // void simpleTest() {
 // 	char buf[64];
 // 	TempMenuItem temp;
@@ -38,7 +53,7 @@ using namespace std;
 // }
 
 // TODO: improve function by showing the cursor on the selected digit when in edit mode
-void drawSection(MenuController& controller) {
+void drawSection(TestController& controller) {
 	// controller.onPreDraw();
 	const char* separator = "------------------------------";
 	char buf[64];
@@ -78,7 +93,7 @@ void drawSection(MenuController& controller) {
 
 void automaticTest() {
 	TestMenu testMenu;
-	MenuController controller(testMenu);
+	TestController controller(testMenu);
 	drawSection(controller);
 
 	cout << "Move down" << endl;
@@ -115,14 +130,99 @@ void automaticTest() {
 	drawSection(controller);
 }
 
+#ifdef MENU_EEPROM_FILE
+/** Seconds since the first call, as the clock of the value store */
+uint32_t hostSeconds() {
+	static const auto start = chrono::steady_clock::now();
+	return chrono::duration_cast<chrono::seconds>(
+			chrono::steady_clock::now() - start).count();
+}
+#endif
+
+#ifdef MENU_TRACE
+/** Microseconds since the first call, as the trace clock of the PC */
+uint32_t hostMicros() {
+	static const auto start = chrono::steady_clock::now();
+	return chrono::duration_cast<chrono::microseconds>(
+			chrono::steady_clock::now() - start).count();
+}
+
+/** Print the actions kept by the trace, and the slowest of them */
+void dumpTrace(const TestController& controller) {
+	static const char* const actions[] = {"up", "down", "left", "right", "enter",
+			"escape", "page up", "page down", "home", "end", "seek", "undo", "redo",
+			"begin", "commit", "rollback"};
+	const MenuTrace<MENU_TRACE_SIZE>& trace = controller.getTrace();
+	cout << "Trace of the last " << trace.getCount() << " of " << trace.getTotal()
+			<< " actions (time us, action, section, result, duration us):" << endl;
+	for (size_t i = 0; i < trace.getCount(); i++) {
+		const MenuTraceEntry& entry = trace.get(i);
+		cout << entry.timestamp << "\t" << actions[(uint8_t)entry.action] << "\t"
+				<< entry.section << "\t" << (int)entry.result << "\t"
+				<< entry.duration << endl;
+	}
+	const MenuTraceEntry* worst = trace.getWorst();
+	if (worst) {
+		cout << "Slowest: " << actions[(uint8_t)worst->action] << " at "
+				<< worst->timestamp << " us, " << worst->duration << " us" << endl;
+	}
+}
+#endif
+
+/** Report the values set by a transaction */
+class PrintCommit : public OnCommitF {
+public:
+	void operator()(const MenuTransaction& transaction) override {
+		int changed = 0;
+		for (uint8_t i = 0; i < transaction.getCount(); i++)
+			changed += transaction.isChanged(i);
+		cout << "Committed " << changed << " values" << endl;
+	}
+};
+
 void interactiveTest() {
+#ifdef MENU_EEPROM_FILE
+	// accepted values are kept in the file MENU_EEPROM_FILE across runs
+	static FileEeprom<1024> eeprom(MENU_EEPROM_FILE);
+	static ValueStore store(eeprom);
+	store.begin();
+	app_registry.restore(store);
+	// values accepted are written once left alone for a few seconds
+	store.setFlushDelay(5);
+#endif
 	TestMenu testMenu;
-	MenuController controller(testMenu);
+	// checked in every build, not only in debug ones
+	bool links_ok = testMenu.checkLinks();
+	bool registry_ok = app_registry.check(testMenu, TestMenu::section_count);
+	if (!links_ok)
+		cout << "Error: a section item leads to no section of the menu" << endl;
+	if (!registry_ok)
+		cout << "Error: the value registry does not match the items" << endl;
+	if (!links_ok || !registry_ok)
+		return;
+	// keep the last section left so that going back to it is immediate
+	SectionCache cache(testMenu.getSectionBytes());
+	// built before the controller takes the arena slots
+	MenuIndex<16> index;
+	index.build(testMenu);
+	TestController controller(testMenu, &cache);
+	controller.setValueRegistry(&app_registry);
+	string prefix;
+	uint16_t found = index.NOT_FOUND;
+	PrintCommit print_commit;
+#ifdef MENU_TRACE
+	controller.setTraceClock(hostMicros);
+#endif
+#ifdef MENU_EEPROM_FILE
+	controller.setValueStore(&store);
+#endif
 	char key;
 	bool running = true;
 
 	do {
-		cout << "Controls - wasd: movement, q: escape, e: enter, z: quit" << endl;
+		cout << "Controls - wasd: movement, q: escape, e: enter, rf: page up/down, "
+				"tg: home/end, /text: search, n: next match, b: begin transaction, "
+				"c: commit, x: rollback, u: undo, y: redo, z: quit" << endl;
 		drawSection(controller);
 		cin >> key;
 		switch (key) {
@@ -144,11 +244,68 @@ void interactiveTest() {
 		case 'e':
 			controller.enter();
 			break;
+		case 'r':
+			controller.pageUp();
+			break;
+		case 'f':
+			controller.pageDown();
+			break;
+		case 't':
+			controller.home();
+			break;
+		case 'g':
+			controller.end();
+			break;
+		case '/':
+			cin >> prefix;
+			found = index.find(prefix.c_str());
+			index.seek(controller, found);
+			break;
+		case 'n':
+			if (found != index.NOT_FOUND) {
+				found = index.find(prefix.c_str(), found + 1);
+				if (found == index.NOT_FOUND)
+					found = index.find(prefix.c_str());
+				index.seek(controller, found);
+			}
+			break;
+		case 'b':
+			controller.beginTransaction(&print_commit);
+			break;
+		case 'c':
+			controller.commit();
+			break;
+		case 'x':
+			controller.rollback();
+			break;
+		case 'u':
+			controller.undo();
+			break;
+		case 'y':
+			controller.redo();
+			break;
 		case 'z':
 			running = false;
 			break;
 		}
+#ifdef MENU_EEPROM_FILE
+		store.poll(hostSeconds());
+#endif
 	} while(running);
+
+#ifdef MENU_TRACE
+	dumpTrace(controller);
+#endif
+#ifdef MENU_STATS
+	const MenuStats& stats = controller.getStats();
+	cout << "Sections created/destroyed: " << stats.sections_created << "/"
+			<< stats.sections_destroyed << endl;
+	cout << "Section bytes live/peak: " << stats.bytes_live << "/"
+			<< stats.bytes_peak << endl;
+	cout << "onExit contexts saved: " << stats.onexit_ctxs_saved << endl;
+	cout << "Format calls: " << stats.format_calls << endl;
+	cout << "Callback calls: " << stats.callback_calls << endl;
+#endif
 }
 
 int main(int argc, char** argv) {
@@ -10,37 +10,52 @@
 enum { CURSOR_RIGHT, CURSOR_LEFT, SELECTION_UP, SELECTION_DOWN, VALUE_UP=1, VALUE_DOWN=-1 };
 
 //=============================================================================
-// MenuController
+// BasicMenuController
 //=============================================================================
 
-MenuController::~MenuController() {
+template<template<class> class NAV>
+BasicMenuController<NAV>::~BasicMenuController() {
+	if (transaction_.isOpen())
+		transaction_.close(false);
 	section_->onExit();
-	delete section_;
-	for (int8_t i = path_.level - 1; i > 0; --i) {
-		sec_onexit_ctxs_[i]->onExit();
-		delete sec_onexit_ctxs_[i];
+	menu_.destroySection(section_);
+	if (store_)
+		store_->flush();
+	if (cache_)
+		cache_->clear(menu_);
+	for (int8_t i = path_.level - 1; i >= 0; --i) {
+		sec_onexit_ctxs_[i].onExit();
+		sec_onexit_ctxs_[i].clear();
 	}
 }
 
-void MenuController::up() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::up() {
+	onPreKeyEvent();
 	if (state_.state_ == StateInfo::Mode::NAVIGATE) {
 		// moveSelection(SELECTION_UP);
 		nav_ctrl_.onMoveUp();
 	} else { // StateInfo::Mode::EDIT
 		changeValue(VALUE_UP);
 	}
+	onPostKeyEvent(MenuAction::UP);
 }
 
-void MenuController::down() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::down() {
+	onPreKeyEvent();
 	if (state_.state_ == StateInfo::Mode::NAVIGATE) {
 		// moveSelection(SELECTION_DOWN);
 		nav_ctrl_.onMoveDown();
 	} else { // StateInfo::Mode::EDIT
 		changeValue(VALUE_DOWN);
 	}
+	onPostKeyEvent(MenuAction::DOWN);
 }
 
-void MenuController::right() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::right() {
+	onPreKeyEvent();
 	if (state_.state_ == StateInfo::Mode::NAVIGATE) {
 		if (getCurrentItem_()->isSection()) {
 			sectionDown();
@@ -50,9 +65,12 @@ void MenuController::right() {
 	} else { // StateInfo::Mode::EDIT
 		moveCursor(CURSOR_RIGHT);
 	}
+	onPostKeyEvent(MenuAction::RIGHT);
 }
 
-void MenuController::enter() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::enter() {
+	onPreKeyEvent();
 	if (state_.state_ == StateInfo::Mode::NAVIGATE) {
 		if (getCurrentItem_()->isSection()) {
 			sectionDown();
@@ -62,31 +80,170 @@ void MenuController::enter() {
 	} else { // StateInfo::Mode::EDIT
 		acceptEdit();
 	}
+	onPostKeyEvent(MenuAction::ENTER);
 }
 
-void MenuController::escape() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::escape() {
+	onPreKeyEvent();
 	if (state_.state_ == StateInfo::Mode::NAVIGATE) {
 		sectionUp();
 	} else { // StateInfo::Mode::EDIT
 		cancelEdit();
 	}
+	onPostKeyEvent(MenuAction::ESCAPE);
 }
 
-void MenuController::left() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::left() {
+	onPreKeyEvent();
 	if (state_.state_ == StateInfo::Mode::NAVIGATE) {
 		sectionUp();
 	} else { // StateInfo::Mode::EDIT
 		moveCursor(CURSOR_LEFT);
 	}
+	onPostKeyEvent(MenuAction::LEFT);
 }
 
-void MenuController::sectionDown() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::pageUp() {
+	onPreKeyEvent();
+	uint8_t visible = nav_ctrl_.getVisibleRows();
+	uint8_t index = getCurrentIndex();
+	jumpTo(index > visible ? index - visible : 0,
+			StateInfo::ActionResult::MENU_PAGE_UP);
+	onPostKeyEvent(MenuAction::PAGE_UP);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::pageDown() {
+	onPreKeyEvent();
+	uint16_t index = getCurrentIndex() + nav_ctrl_.getVisibleRows();
+	uint8_t last = section_->getSize() - 1;
+	jumpTo(index < last ? index : last, StateInfo::ActionResult::MENU_PAGE_DOWN);
+	onPostKeyEvent(MenuAction::PAGE_DOWN);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::home() {
+	onPreKeyEvent();
+	jumpTo(0, StateInfo::ActionResult::MENU_MOVE_TOP);
+	onPostKeyEvent(MenuAction::HOME);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::end() {
+	onPreKeyEvent();
+	jumpTo(section_->getSize() - 1, StateInfo::ActionResult::MENU_MOVE_BOTTOM);
+	onPostKeyEvent(MenuAction::END);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::seek(uint8_t index) {
+	onPreKeyEvent();
+	jumpTo(index, StateInfo::ActionResult::MENU_JUMP);
+	onPostKeyEvent(MenuAction::SEEK);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::seek(const Path& path) {
+	onPreKeyEvent();
+	if (state_.state_ != StateInfo::Mode::NAVIGATE || path.level >= MAX_MENU_DEPTH
+			|| path.section_id[0] != path_.section_id[0]) {
+		state_.result_ = StateInfo::ActionResult::MENU_JUMP_FAILED;
+		onPostKeyEvent(MenuAction::SEEK);
+		return;
+	}
+	// last level at which both paths are in the same section
+	uint8_t common = 0;
+	while (common < path_.level && common < path.level
+			&& path_.section_id[common + 1] == path.section_id[common + 1]
+			&& path_.item_idx[common] == path.item_idx[common])
+		common++;
+	while (path_.level > common)
+		sectionUp();
+	bool valid = true;
+	while (valid && path_.level < path.level) {
+		uint8_t index = path.item_idx[path_.level];
+		valid = index < section_->getSize();
+		if (valid) {
+			setCurrentIndex(index);
+			AbstractMenuItem* item = getCurrentItem_();
+			valid = item->isSection() && ((SectionMenuItem*)item)->getSectionId()
+					== path.section_id[path_.level + 1];
+		}
+		if (valid) {
+			sectionDown();
+			valid = state_.result_ == StateInfo::ActionResult::MENU_LEVEL_DOWN;
+		}
+	}
+	if (valid && path.item_idx[path_.level] < section_->getSize()) {
+		nav_ctrl_.onSeek(path.item_idx[path_.level]);
+		state_.result_ = StateInfo::ActionResult::MENU_JUMP;
+	} else {
+		nav_ctrl_.onSeek(getCurrentIndex());
+		state_.result_ = StateInfo::ActionResult::MENU_JUMP_FAILED;
+	}
+	// the section may have changed on the way
+	state_.markPage();
+	onPostKeyEvent(MenuAction::SEEK);
+}
+
+/**
+ * Get a section from the cache if possible, otherwise create it, evicting
+ * cached sections if the factory runs out of memory.
+ */
+template<template<class> class NAV>
+BaseMenuSection* BasicMenuController<NAV>::createSection(uint16_t section) {
+	BaseMenuSection* created = cache_ ? cache_->take(section) : NULL;
+	if (created) {
+		// values may have changed while it was in the cache
+		AbstractMenuItem** items = created->getItems();
+		for (uint8_t i = 0; i < created->getSize(); i++) {
+			if (!items[i]->isSection())
+				((EndpointMenuItem*)items[i])->invalidateValueString();
+		}
+		return created;
+	}
+	while ((created = menu_.createSection(section)) == NULL
+			&& cache_ && cache_->evict(menu_)) { }
+	return created;
+}
+
+/** Keep the section in the cache if there is one, otherwise destroy it. */
+template<template<class> class NAV>
+void BasicMenuController<NAV>::releaseSection(BaseMenuSection* section) {
+	// the items must wrap their own variables again before leaving them
+	if (transaction_.getSection() == section)
+		transaction_.close(false);
+	if (cache_)
+		cache_->put(section, menu_);
+	else
+		menu_.destroySection(section);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::sectionDown() {
 	// decouple the context of the current section and keep it. Then destroy the
 	// section
-	sec_onexit_ctxs_[path_.level++] = section_->getOnExitContext();
+	if (path_.level == MAX_MENU_DEPTH - 1) {
+		state_.result_ = StateInfo::ActionResult::MENU_AT_MAX_DEPTH;
+		return;
+	}
 	uint16_t sec_id = ((SectionMenuItem*)getCurrentItem_())->getSectionId();
-	delete section_;
-	section_ = menu_.createSection(sec_id);
+	section_->saveOnExitContext(sec_onexit_ctxs_[path_.level++]);
+	releaseSection(section_);
+	if (store_)
+		store_->flush();
+	section_ = createSection(sec_id);
+	if (!section_) {
+		// no such section, or no memory for it: stay in the current one
+		sec_onexit_ctxs_[--path_.level].clear();
+		section_ = createSection(path_.section_id[path_.level]);
+		state_.result_ = StateInfo::ActionResult::MENU_SECTION_FAILED;
+		nav_ctrl_.onSectionUp();
+		return;
+	}
 	path_.section_id[path_.level] = sec_id;
 	path_.item_idx[path_.level] = 0;
 	state_.result_ = StateInfo::ActionResult::MENU_LEVEL_DOWN;
@@ -94,110 +251,390 @@ void MenuController::sectionDown() {
 	nav_ctrl_.onSectionDown();
 }
 
-void MenuController::sectionUp() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::sectionUp() {
 	// check if top section
 	if (path_.level == 0) {
 		state_.result_ = StateInfo::ActionResult::MENU_AT_ROOT;
 		return;
 	}
 	section_->onExit();
-	delete section_;
+	releaseSection(section_);
+	if (store_)
+		store_->flush();
 	// TODO: pass this to createSection rather than destroying it
-	delete sec_onexit_ctxs_[--path_.level];
-	section_ = menu_.createSection(path_.section_id[path_.level]);
+	sec_onexit_ctxs_[--path_.level].clear();
+	section_ = createSection(path_.section_id[path_.level]);
 	state_.result_ = StateInfo::ActionResult::MENU_LEVEL_UP;
 
 	nav_ctrl_.onSectionUp();
 }
 
-void MenuController::startEdit() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::startEdit() {
 	EndpointMenuItem* item = (EndpointMenuItem*)getCurrentItem_();
 	state_.state_ = StateInfo::Mode::EDIT;
 	temp_item_.startEdit(item);
-	char buf[16];
-	item->getValueAsString(buf, sizeof(buf));
-	state_.substate_ = strlen(buf) - 1;
+	state_.substate_ = 0; // lowest digit
 	state_.result_ = StateInfo::ActionResult::EDIT_START;
+	markCurrentRow(StateInfo::DIRTY_MODE | StateInfo::DIRTY_CURSOR);
 }
 
-void MenuController::acceptEdit() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::acceptEdit() {
+	EndpointMenuItem* item = (EndpointMenuItem*)getCurrentItem_();
+	ValueUnion old_value = temp_item_.getOriginalValue();
 	state_.state_ = StateInfo::Mode::NAVIGATE;
-	temp_item_.endEdit(true);
-	// TODO: send message here or in TempMenuItem?
+	temp_item_.endEdit(true, !transaction_.isOpen());
+	if (!transaction_.isOpen()) {
+		recordChange(item, &old_value, item->getValuePointer(), false);
+		if (store_)
+			store_->put(item->getValueStorageId(), item->getValuePointer(), item->getValueSize());
+	}
 	state_.result_ = StateInfo::ActionResult::EDIT_ACCEPT;
+	markCurrentRow(StateInfo::DIRTY_MODE);
+	refreshValue(item->getValuePointer());
 }
 
-void MenuController::cancelEdit() {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::cancelEdit() {
 	state_.state_ = StateInfo::Mode::NAVIGATE;
 	temp_item_.endEdit(false);
 	state_.result_ = StateInfo::ActionResult::EDIT_CANCEL;
+	markCurrentRow(StateInfo::DIRTY_MODE | StateInfo::DIRTY_VALUE);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::beginTransaction(OnCommitF* on_commit) {
+	onPreKeyEvent();
+	if (state_.state_ != StateInfo::Mode::NAVIGATE || transaction_.isOpen()
+			|| !transaction_.open(section_)) {
+		state_.result_ = StateInfo::ActionResult::TRANSACTION_FAILED;
+	} else {
+		on_commit_ = on_commit;
+		state_.result_ = StateInfo::ActionResult::TRANSACTION_BEGIN;
+	}
+	onPostKeyEvent(MenuAction::BEGIN);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::commit() {
+	onPreKeyEvent();
+	if (!transaction_.isOpen()) {
+		state_.result_ = StateInfo::ActionResult::TRANSACTION_FAILED;
+		onPostKeyEvent(MenuAction::COMMIT);
+		return;
+	}
+	if (state_.state_ == StateInfo::Mode::EDIT) {
+		state_.state_ = StateInfo::Mode::NAVIGATE;
+		temp_item_.endEdit(true, false);
+		markCurrentRow(StateInfo::DIRTY_MODE);
+		refreshValue(((EndpointMenuItem*)getCurrentItem_())->getValuePointer());
+	}
+	if (on_commit_) {
+		MENU_STATS_INC(callback_calls);
+		if (!on_commit_->validate(transaction_)) {
+			state_.result_ = StateInfo::ActionResult::TRANSACTION_FAILED;
+			onPostKeyEvent(MenuAction::COMMIT);
+			return;
+		}
+	}
+	bool linked = false;
+	for (uint8_t i = 0; i < transaction_.getCount(); i++) {
+		EndpointMenuItem* item = transaction_.getItem(i);
+		if (transaction_.isChanged(i)) {
+			recordChange(item, transaction_.getSource(i), item->getValuePointer(), linked);
+			linked = true;
+		}
+	}
+	endTransaction(true);
+	if (store_) {
+		for (uint8_t i = 0; i < transaction_.getCount(); i++) {
+			EndpointMenuItem* item = transaction_.getItem(i);
+			if (transaction_.isChanged(i))
+				store_->put(item->getValueStorageId(), item->getValuePointer(),
+						item->getValueSize());
+		}
+		store_->flush();
+	}
+	if (on_commit_) {
+		MENU_STATS_INC(callback_calls);
+		(*on_commit_)(transaction_);
+	}
+	state_.result_ = StateInfo::ActionResult::TRANSACTION_COMMIT;
+	onPostKeyEvent(MenuAction::COMMIT);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::rollback() {
+	onPreKeyEvent();
+	if (!transaction_.isOpen()) {
+		state_.result_ = StateInfo::ActionResult::TRANSACTION_FAILED;
+	} else {
+		if (state_.state_ == StateInfo::Mode::EDIT) {
+			state_.state_ = StateInfo::Mode::NAVIGATE;
+			temp_item_.endEdit(false);
+		}
+		endTransaction(false);
+		state_.result_ = StateInfo::ActionResult::TRANSACTION_ROLLBACK;
+	}
+	onPostKeyEvent(MenuAction::ROLLBACK);
+}
+
+/**
+ * Close the transaction. Every value shown may change, and so may the mode.
+ */
+template<template<class> class NAV>
+void BasicMenuController<NAV>::endTransaction(bool commit) {
+	transaction_.close(commit);
+	state_.markPage();
+}
+
+/**
+ * Refresh the items of the section that wrap a variable whose value changed,
+ * since all of them show the new value.
+ */
+template<template<class> class NAV>
+void BasicMenuController<NAV>::refreshValue(const void* variable) {
+	AbstractMenuItem** items = section_->getItems();
+	uint8_t first = nav_ctrl_.getFirst();
+	uint8_t size;
+	nav_ctrl_.getVisible(&size);
+	for (uint8_t i = 0; i < section_->getSize(); i++) {
+		if (items[i]->isSection())
+			continue;
+		EndpointMenuItem* item = (EndpointMenuItem*)items[i];
+		if (item->getValuePointer() != variable)
+			continue;
+		item->invalidateValueString();
+		if (i >= first && i < first + size)
+			state_.markRow(i - first, StateInfo::DIRTY_VALUE);
+	}
 }
 
-void MenuController::moveCursor(int8_t dir) {
+//========== History ===========
+
+/** Keep a change of the value of item in the history, if it did change */
+template<template<class> class NAV>
+void BasicMenuController<NAV>::recordChange(const EndpointMenuItem* item,
+		const void* old_value, const void* new_value, bool linked) {
+	MenuHistoryEntry entry{};
+	entry.size = item->getValueSize();
+	if (memcmp(old_value, new_value, entry.size) == 0)
+		return;
+	memcpy(&entry.old_value, old_value, entry.size);
+	memcpy(&entry.new_value, new_value, entry.size);
+	entry.value_id = item->getValueStorageId();
+	entry.linked = linked;
+	history_.record(entry);
+}
+
+/** Item of the current section with the value ID, or NULL */
+template<template<class> class NAV>
+EndpointMenuItem* BasicMenuController<NAV>::findItem(uint16_t value_id) {
+	AbstractMenuItem** items = section_->getItems();
+	for (uint8_t i = 0; i < section_->getSize(); i++) {
+		if (!items[i]->isSection()
+				&& ((EndpointMenuItem*)items[i])->getValueStorageId() == value_id)
+			return (EndpointMenuItem*)items[i];
+	}
+	return NULL;
+}
+
+template<template<class> class NAV>
+bool BasicMenuController<NAV>::canSetValue(uint16_t value_id) {
+	return findItem(value_id) || (registry_ && registry_->find(value_id));
+}
+
+/**
+ * Set the old value of an entry if undoing it, otherwise the new one. It must
+ * be reachable, see canSetValue().
+ */
+template<template<class> class NAV>
+void BasicMenuController<NAV>::setValue(const MenuHistoryEntry& entry, bool undo) {
+	const ValueUnion& value = undo ? entry.old_value : entry.new_value;
+	EndpointMenuItem* item = findItem(entry.value_id);
+	void* variable = item ? item->getValuePointer() : registry_->find(entry.value_id)->address;
+	memcpy(variable, &value, entry.size);
+	if (item)
+		refreshValue(variable);
+	// items of other sections may be alive in the cache
+	if (cache_)
+		cache_->invalidate(variable);
+	if (store_)
+		store_->put(entry.value_id, variable, entry.size);
+	if (on_undo_) {
+		MENU_STATS_INC(callback_calls);
+		(*on_undo_)(entry, undo);
+	}
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::undo() {
+	onPreKeyEvent();
+	uint8_t n = history_.getUndoCount();
+	bool ok = n > 0 && state_.state_ == StateInfo::Mode::NAVIGATE && !transaction_.isOpen();
+	for (uint8_t i = 0; ok && i < n; i++)
+		ok = canSetValue(history_.getUndo(i).value_id);
+	if (ok) {
+		for (uint8_t i = 0; i < n; i++)
+			setValue(history_.getUndo(i), true);
+		history_.undone(n);
+		state_.result_ = StateInfo::ActionResult::HISTORY_UNDO;
+	} else
+		state_.result_ = StateInfo::ActionResult::HISTORY_FAILED;
+	onPostKeyEvent(MenuAction::UNDO);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::redo() {
+	onPreKeyEvent();
+	uint8_t n = history_.getRedoCount();
+	bool ok = n > 0 && state_.state_ == StateInfo::Mode::NAVIGATE && !transaction_.isOpen();
+	for (uint8_t i = 0; ok && i < n; i++)
+		ok = canSetValue(history_.getRedo(i).value_id);
+	if (ok) {
+		for (uint8_t i = 0; i < n; i++)
+			setValue(history_.getRedo(i), false);
+		history_.redone(n);
+		state_.result_ = StateInfo::ActionResult::HISTORY_REDO;
+	} else
+		state_.result_ = StateInfo::ActionResult::HISTORY_FAILED;
+	onPostKeyEvent(MenuAction::REDO);
+}
+
+template<template<class> class NAV>
+void BasicMenuController<NAV>::moveCursor(int8_t dir) {
 	EndpointMenuItem* item = (EndpointMenuItem*)getCurrentItem_();
 	bool cursor = item->isCursorEditable();
 	if (!cursor) {
 		state_.result_ = StateInfo::ActionResult::EDIT_CURSOR_BLOCKED;
 		return;
 	}
-	char buf[16];
-	item->getValueAsString(buf, sizeof(buf));
-	uint8_t len = strlen(buf);
+	// the cursor is the digit exponent, so right is towards digit 0
+	uint8_t count = item->getDigitCount();
 	if (dir == CURSOR_RIGHT) {
-		state_.substate_++;
-		// jump across the comma
-		if (buf[state_.substate_] == '.')
-			state_.substate_++;
-		if (state_.substate_ == len)
-			state_.substate_ = 0;
+		if (state_.substate_ == 0 || state_.substate_ >= count)
+			state_.substate_ = count - 1;
+		else
+			state_.substate_--;
 		state_.result_ = StateInfo::ActionResult::EDIT_CURSOR_RIGHT;
 	} else {
-		if (state_.substate_ == 0)
-			state_.substate_ = len - 1;
-		else {
-			state_.substate_--;
-			// jump across the comma
-			if (buf[state_.substate_] == '.')
-				state_.substate_--;
-		}
+		state_.substate_++;
+		if (state_.substate_ >= count)
+			state_.substate_ = 0;
 		state_.result_ = StateInfo::ActionResult::EDIT_CURSOR_LEFT;
 	}
+	markCurrentRow(StateInfo::DIRTY_CURSOR);
 }
 
-void MenuController::changeValue(int8_t dir) {
+template<template<class> class NAV>
+void BasicMenuController<NAV>::changeValue(int16_t dir) {
 	EndpointMenuItem* item = (EndpointMenuItem*)getCurrentItem_();
 	bool res;
-	if (item->isCursorEditable()) {
-		char buf[16];
-		item->getValueAsString(buf, sizeof(buf));
-		uint8_t digit;
-		if (item->getType() == MenuItemType::float32) {
-			// don't count the comma as a digit
-			char* comma = strchr(buf, '.');
-			digit = strlen(buf) - state_.substate_ - 1;
-			if (state_.substate_ < comma - buf) {
-				digit -= 1;
-			}
-		} else {
-			digit = strlen(buf) - state_.substate_ - 1;
-		}
-		res = item->changeValue(digit, dir);
-	} else {
+	if (item->isCursorEditable())
+		res = item->changeValue(state_.substate_, dir);
+	else
 		res = item->changeValue(0, dir);
-	}
 	if (res) {
-		if (dir == VALUE_UP)
+		if (dir >= VALUE_UP)
 			state_.result_ = StateInfo::ActionResult::EDIT_VALUE_UP;
 		else
 			state_.result_ = StateInfo::ActionResult::EDIT_VALUE_DOWN;
+		markCurrentRow(StateInfo::DIRTY_VALUE);
 	} else {
-		if (dir == VALUE_UP)
+		if (dir >= VALUE_UP)
 			state_.result_ = StateInfo::ActionResult::EDIT_TOP_REACHED;
 		else
 			state_.result_ = StateInfo::ActionResult::EDIT_BOTTOM_REACHED;
 	}
 }
 
+/**
+ * Select the item at index with a single move of the navigation controller.
+ * @return false if not possible, in edit mode or with an invalid index
+ */
+template<template<class> class NAV>
+bool BasicMenuController<NAV>::jumpTo(uint8_t index, StateInfo::ActionResult result) {
+	if (state_.state_ != StateInfo::Mode::NAVIGATE || index >= section_->getSize()) {
+		state_.result_ = StateInfo::ActionResult::MENU_JUMP_FAILED;
+		return false;
+	}
+	nav_ctrl_.onSeek(index);
+	state_.result_ = result;
+	return true;
+}
+
+/**
+ * Move the selection several rows at once, down if positive, wrapping around
+ * the ends like single moves do.
+ */
+template<template<class> class NAV>
+void BasicMenuController<NAV>::moveBy(int16_t rows) {
+	int16_t size = section_->getSize();
+	int16_t index = getCurrentIndex() + rows;
+	StateInfo::ActionResult result = rows > 0
+			? StateInfo::ActionResult::MENU_MOVE_DOWN
+			: StateInfo::ActionResult::MENU_MOVE_UP;
+	if (index >= size) {
+		result = StateInfo::ActionResult::MENU_MOVE_TOP;
+		while (index >= size)
+			index -= size;
+	} else if (index < 0) {
+		result = StateInfo::ActionResult::MENU_MOVE_BOTTOM;
+		while (index < 0)
+			index += size;
+	}
+	nav_ctrl_.onSeek(index);
+	state_.result_ = result;
+}
+
+/** Run an event of the queue repeated count times */
+template<template<class> class NAV>
+void BasicMenuController<NAV>::dispatch(MenuAction action, uint8_t count) {
+	bool vertical = action == MenuAction::UP || action == MenuAction::DOWN;
+	if (vertical && count > 1 && state_.state_ == StateInfo::Mode::NAVIGATE) {
+		onPreKeyEvent();
+		moveBy(action == MenuAction::UP ? -count : count);
+		onPostKeyEvent(action);
+		return;
+	}
+	// in edit mode, n changes of the value are a single one of n steps
+	if (vertical && count > 1) {
+		onPreKeyEvent();
+		changeValue(action == MenuAction::UP ? count * VALUE_UP : count * VALUE_DOWN);
+		onPostKeyEvent(action);
+		return;
+	}
+	for (uint8_t i = 0; i < count; i++) {
+		switch (action) {
+		case MenuAction::UP: up(); break;
+		case MenuAction::DOWN: down(); break;
+		case MenuAction::LEFT: left(); break;
+		case MenuAction::RIGHT: right(); break;
+		case MenuAction::ENTER: enter(); break;
+		case MenuAction::ESCAPE: escape(); break;
+		case MenuAction::PAGE_UP: pageUp(); break;
+		case MenuAction::PAGE_DOWN: pageDown(); break;
+		case MenuAction::HOME: home(); break;
+		case MenuAction::END: end(); break;
+		case MenuAction::SEEK: break; // needs a target, cannot be queued
+		case MenuAction::UNDO: undo(); break;
+		case MenuAction::REDO: redo(); break;
+		case MenuAction::BEGIN: beginTransaction(); break;
+		case MenuAction::COMMIT: commit(); break;
+		case MenuAction::ROLLBACK: rollback(); break;
+		}
+		// no point in pushing a value past its limits, or in the history, or
+		// in repeating a transaction action
+		if (state_.result_ == StateInfo::ActionResult::EDIT_TOP_REACHED
+				|| state_.result_ == StateInfo::ActionResult::EDIT_BOTTOM_REACHED
+				|| state_.result_ == StateInfo::ActionResult::HISTORY_FAILED
+				|| state_.result_ == StateInfo::ActionResult::TRANSACTION_FAILED)
+			break;
+	}
+}
+
 // void MenuController::moveSelection(int8_t dir) {
 // 	if (dir == SELECTION_UP) {
 // 		if (path_.item_idx == 0) {
@@ -218,3 +655,7 @@ void MenuController::changeValue(int8_t dir) {
 // 		}
 // 	}
 // }
+
+// instantiate the controller for every navigation policy available
+template class BasicMenuController<MenuNavByPages>;
+template class BasicMenuController<MenuNavScroll>;
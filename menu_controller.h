@@ -9,7 +9,6 @@
 #define MENU_CONTROLLER_H
 
 #include <string.h>
-#include <stdio.h>
 #include <cstdint>
 #include <cfloat>
 #include "functors.h"
@@ -17,8 +16,26 @@
 #include "menu_factory.h"
 #include "menu_item.h"
 #include "menu_section.h"
-
+#include "section_cache.h"
+#include "menu_trace.h"
+#include "menu_events.h"
+#include "value_store.h"
+#include "menu_transaction.h"
+#include "menu_history.h"
+#include "value_registry.h"
+
+#ifndef MAX_MENU_DEPTH
 #define MAX_MENU_DEPTH 8
+#endif
+
+/**
+ * Default number of rows of the display, i.e. items shown at a time. It can
+ * be given to the controller, or changed at runtime with setVisibleRows().
+ */
+#ifndef MENU_VISIBLE_ROWS
+#define MENU_VISIBLE_ROWS 2
+#endif
+static_assert(MENU_VISIBLE_ROWS > 0, "MENU_VISIBLE_ROWS must be at least 1");
 
 //=============================================================================
 // StateInfo
@@ -51,24 +68,103 @@ public:
 		MENU_LEVEL_DOWN,
 		MENU_LEVEL_UP,
 		MENU_AT_ROOT, // tried to go one level up when already at the root
+		MENU_AT_MAX_DEPTH, // tried to go one level down past MAX_MENU_DEPTH
+		MENU_SECTION_FAILED, // the factory could not create the section entered
 		MENU_MOVE_DOWN, // navigate to the item below
 		MENU_MOVE_UP, // navigate to the item above
-		MENU_MOVE_TOP, // selection to top after wrapping around at the bottom
-		MENU_MOVE_BOTTOM // the other way around
+		MENU_MOVE_TOP, // selection to top after wrapping around at the bottom, or home
+		MENU_MOVE_BOTTOM, // the other way around, or end
+		MENU_PAGE_UP, // selection moved one page up
+		MENU_PAGE_DOWN, // selection moved one page down
+		MENU_JUMP, // seek to an item or to a path done
+		MENU_JUMP_FAILED, // invalid seek, or jump not allowed in edit mode
+
+		TRANSACTION_BEGIN,
+		TRANSACTION_COMMIT,
+		TRANSACTION_ROLLBACK,
+		TRANSACTION_FAILED, // could not begin, none open, or values rejected
+
+		HISTORY_UNDO,
+		HISTORY_REDO,
+		HISTORY_FAILED // nothing to undo or redo, or some value is not reachable
+	};
+
+	/**
+	 * Kind of changes made by the last action, so that the GUI can redraw just
+	 * what is needed. Combined as bit flags.
+	 */
+	enum DirtyFlags : uint8_t {
+		DIRTY_NONE = 0,
+		DIRTY_CURSOR = 0x01, // the selection or the edit cursor moved
+		DIRTY_VALUE = 0x02, // the value of some items changed
+		DIRTY_MODE = 0x04, // edit mode was entered or left
+		DIRTY_PAGE = 0x08, // the visible items are different, redraw everything
+		DIRTY_SCROLL = 0x10 // the visible items shifted, see getScroll()
 	};
 
 private:
-	uint8_t substate_{0}; // in edit mode it is the position of the cursor
+	uint8_t substate_{0}; // in edit mode it is the digit under the cursor, 0 is the lowest
 	Mode state_{Mode::NAVIGATE};
 	ActionResult result_{ActionResult::MENU_LEVEL_DOWN}; // to signal screen refresh on start
-	friend class MenuController;
-	friend class MenuNavByPages;
+	uint8_t dirty_flags_{DIRTY_PAGE};
+	uint16_t dirty_rows_{0xFFFF}; // bit N set if visible row N must be redrawn
+	int8_t scroll_{0}; // rows the visible items shifted up, negative if down
+	template<template<class> class NAV> friend class BasicMenuController;
+	template<class CTRL> friend class MenuNavByPages;
+	template<class CTRL> friend class MenuNavScroll;
+
+	void clearDirty() {
+		dirty_flags_ = DIRTY_NONE;
+		dirty_rows_ = 0;
+		scroll_ = 0;
+	}
+	/** Shift the visible items by rows, positive if they move up */
+	void markScroll(int8_t rows) {
+		// rows marked before, e.g. earlier in a batch, would be wrong after it
+		if (dirty_rows_ != 0 || (dirty_flags_ & DIRTY_SCROLL)) {
+			markPage();
+			return;
+		}
+		dirty_flags_ |= DIRTY_SCROLL;
+		scroll_ = rows;
+	}
+	/** Mark a visible row, 0 being the first one shown */
+	void markRow(uint8_t row, uint8_t flags) {
+		dirty_flags_ |= flags;
+		if (row < 16)
+			dirty_rows_ |= 1 << row;
+		else
+			markPage();
+	}
+	void markPage() {
+		dirty_flags_ |= DIRTY_PAGE;
+		dirty_rows_ = 0xFFFF;
+	}
 
 public:
+	/**
+	 * In edit mode, the digit under the cursor. Digit 0 is the last one of the
+	 * string representation, not counting the decimal point.
+	 */
 	uint8_t getSubstate() const {
 		return substate_;
 	}
 
+	/**
+	 * Helper for the GUI: position in the string representation of a value of
+	 * the digit under the cursor.
+	 */
+	static uint8_t getCursorPosition(const char* value_str, uint8_t digit) {
+		int8_t i = strlen(value_str) - 1;
+		for (; i > 0; i--) {
+			if (value_str[i] == '.')
+				continue;
+			if (digit-- == 0)
+				break;
+		}
+		return i;
+	}
+
 	Mode getState() const {
 		return state_;
 	}
@@ -81,6 +177,34 @@ public:
 		result_ = ActionResult::OK;
 	}
 
+	/** Combination of DirtyFlags describing the changes of the last action */
+	uint8_t getDirtyFlags() const {
+		return dirty_flags_;
+	}
+
+	/**
+	 * Visible rows that changed in the last action as a bit mask, bit 0 being
+	 * the first row shown. All bits are set when the whole page is dirty.
+	 */
+	uint16_t getDirtyRows() const {
+		return dirty_rows_;
+	}
+
+	bool isRowDirty(uint8_t row) const {
+		return row >= 16 ? (dirty_flags_ & DIRTY_PAGE) : (dirty_rows_ >> row) & 1;
+	}
+
+	/**
+	 * Rows that the visible items shifted in the last action, if DIRTY_SCROLL
+	 * is set, so that the display can scroll its contents instead of redrawing
+	 * them. Positive means that they moved up, so the first row left and the
+	 * last one entered, and negative the other way around. The dirty rows are
+	 * given after the shift and include the one that entered.
+	 */
+	int8_t getScroll() const {
+		return scroll_;
+	}
+
 	/** Convenience function */
 	bool isLevelChanged() {
 		return result_ == ActionResult::MENU_LEVEL_DOWN ||
@@ -89,111 +213,355 @@ public:
 };
 
 //=============================================================================
-// MenuNavByPages
+// Navigation policies
 //=============================================================================
 
+/*
+ * A navigation policy decides which items of the section are visible as the
+ * selection moves, and marks the rows that change in the StateInfo. It is a
+ * template parameter of BasicMenuController, which is its CTRL parameter, and
+ * it must provide the following, taking a visible of 0 as 1:
+ *
+ *     Policy(CTRL& ctrl, uint8_t visible);
+ *     void setVisible(uint8_t visible);
+ *     uint8_t getVisibleRows() const;
+ *     void onSectionDown();
+ *     void onSectionUp();
+ *     void onMoveDown();
+ *     void onMoveUp();
+ *     void onSeek(uint8_t index);
+ *     const AbstractMenuItem* const * getVisible(uint8_t* size) const;
+ *     uint8_t getFirst() const;
+ *     uint8_t getPosition() const;
+ *     uint8_t getPages() const;
+ */
+
+/**
+ * Shows the items in pages of a fixed number of rows, and changes the whole
+ * page when the selection moves past the top or bottom.
+ *
+ * The page and its bounds are updated incrementally as the selection moves, so
+ * that no division is needed, which is slow in 8 bit cores without hardware
+ * divide.
+ */
+template<class CTRL>
 class MenuNavByPages {
-	class MenuController& ctrl_;
-	uint8_t first_idx_;
-	uint8_t last_idx_;
-	const uint8_t visible_;		// items per page
+	CTRL& ctrl_;
+	uint8_t first_idx_{0};
+	uint8_t last_idx_{0};
+	uint8_t page_{0};
+	uint8_t pages_{0};
+	uint8_t visible_;		// items per page
 private:
+	// count the pages of the current section and show the first one
+	void setSection();
 	// set first and last pointers according to page number and size
 	void changePage(uint8_t page);
+	// step through the pages until the one of the current item
+	void showCurrent();
+	// update the dirty rows of the StateInfo after moving the selection
+	void markMove(uint8_t prev_first, uint8_t prev_row);
 public:
-	MenuNavByPages(class MenuController& ctrl, uint8_t visible);
+	MenuNavByPages(CTRL& ctrl, uint8_t visible);
+	/** Change the items per page, keeping the current item visible */
+	void setVisible(uint8_t visible);
+	uint8_t getVisibleRows() const { return visible_; }
 	// show first page
 	void onSectionDown();
 	// show previous page
 	void onSectionUp();
 	void onMoveDown();
 	void onMoveUp();
+	/** Select any item, showing its page */
+	void onSeek(uint8_t index);
 	const AbstractMenuItem* const * getVisible(uint8_t* size) const;
+	/** Index in the section of the first visible item */
+	uint8_t getFirst() const { return first_idx_; }
 	/** Max number of positions -- the number of pages */
 	uint8_t getCount() const { return last_idx_ - first_idx_; }
 	/** Current position in the count -- the page */
-	uint8_t getPosition() const;
+	uint8_t getPosition() const { return page_ + 1; }
 	/** Total number of pages */
-	uint8_t getPages() const;
+	uint8_t getPages() const { return pages_; }
+};
+
+/**
+ * Shows a window of a fixed number of rows that follows the selection one row
+ * at a time, like a scrolling list. When the selection moves past the top or
+ * bottom of the window, the items shift one row and only the one entering
+ * must be drawn, see StateInfo::getScroll().
+ */
+template<class CTRL>
+class MenuNavScroll {
+	CTRL& ctrl_;
+	uint8_t first_idx_{0};
+	uint8_t visible_;		// rows of the window
+private:
+	uint8_t getSize() const { return ctrl_.section_->getSize(); }
+	// make the window show the current item, as low as possible
+	void showCurrent();
+public:
+	MenuNavScroll(CTRL& ctrl, uint8_t visible)
+		: ctrl_(ctrl), visible_(visible > 0 ? visible : 1) { }
+	/** Change the rows of the window, keeping the current item visible */
+	void setVisible(uint8_t visible);
+	uint8_t getVisibleRows() const { return visible_; }
+	void onSectionDown();
+	void onSectionUp();
+	void onMoveDown();
+	void onMoveUp();
+	/** Select any item, moving the window as little as possible */
+	void onSeek(uint8_t index);
+	const AbstractMenuItem* const * getVisible(uint8_t* size) const;
+	/** Index in the section of the first visible item */
+	uint8_t getFirst() const { return first_idx_; }
+	/** Position of the selection, starting at 1, e.g. for a scroll bar */
+	uint8_t getPosition() const { return ctrl_.getCurrentIndex() + 1; }
+	/** Number of positions, i.e. of items */
+	uint8_t getPages() const { return getSize(); }
 };
 
 //=============================================================================
-// MenuController
+// BasicMenuController
 //=============================================================================
 
-class MenuController {
+/**
+ * Controller of the menu, with the navigation policy NAV, e.g. MenuNavByPages
+ * or MenuNavScroll. The controllers for the policies available are
+ * instantiated in menu_controller.cpp, and named below.
+ */
+template<template<class> class NAV>
+class BasicMenuController {
 public:
 	/**
 	 * Description of the menu path followed until the current section.
 	 */
 	struct Path {
-		const uint8_t max_depth = MAX_MENU_DEPTH;
+		static const uint8_t max_depth = MAX_MENU_DEPTH;
 		uint8_t level{0}; // current level in the menu
-		uint8_t section_id[MAX_MENU_DEPTH]{0};
+		uint16_t section_id[MAX_MENU_DEPTH]{0};
 		uint8_t item_idx[MAX_MENU_DEPTH]{0};
 	};
 
 private:
 	MenuFactory& menu_; // defines the menu and generates sections
+	SectionCache* cache_; // optional, keeps recently left sections alive
+	ValueStore* store_{NULL}; // optional, persists the values accepted
+	MenuTransaction transaction_;
+	OnCommitF* on_commit_{NULL};
+	const ValueRegistry* registry_{NULL}; // optional, reaches values of other sections
+	MenuHistory<MENU_HISTORY_SIZE> history_;
+	OnUndoF* on_undo_{NULL};
 	BaseMenuSection *section_;
 	Path path_;
 	TempMenuItem temp_item_;
 	StateInfo state_;
-	// EventQueue& event_queue_;
-	SecOnExitCtx* sec_onexit_ctxs_[MAX_MENU_DEPTH];
+	bool batch_{false}; // processing events, so the StateInfo accumulates
+	SecOnExitCtx sec_onexit_ctxs_[MAX_MENU_DEPTH];
 
-	friend MenuNavByPages;
-	// MenuNavByPages nav_ctrl_{*this, 5};
-	MenuNavByPages nav_ctrl_;
+public:
+	typedef NAV<BasicMenuController> NavCtrl;
+private:
+	friend NavCtrl;
+	NavCtrl nav_ctrl_;
+#ifdef MENU_TRACE
+	MenuTrace<MENU_TRACE_SIZE> trace_;
+	MenuTraceClock trace_clock_{NULL};
+	uint32_t trace_start_{0};
+#endif
 
 private:
-	void onPreKeyEvent() {}
-	void onPostKeyEvent() {}
+	void onPreKeyEvent() {
+		if (!batch_)
+			state_.clearDirty();
+#ifdef MENU_TRACE
+		if (trace_clock_)
+			trace_start_ = trace_clock_();
+#endif
+	}
+	void onPostKeyEvent(MenuAction action) {
+#ifdef MENU_TRACE
+		uint32_t end = trace_clock_ ? trace_clock_() : 0;
+		trace_.record({trace_start_, end - trace_start_, path_.section_id[path_.level],
+				action, (uint8_t)state_.result_});
+#endif
+	}
 	AbstractMenuItem* getCurrentItem_() { return section_->getItems()[path_.item_idx[path_.level]]; }
 	void setCurrentIndex(uint8_t index) { path_.item_idx[path_.level] = index; }
+	void markCurrentRow(uint8_t flags) {
+		state_.markRow(getCurrentIndex() - nav_ctrl_.getFirst(), flags);
+	}
 
+	BaseMenuSection* createSection(uint16_t section);
+	void releaseSection(BaseMenuSection* section);
 	void sectionDown();
 	void sectionUp();
 	void startEdit();
 	void acceptEdit();
 	void cancelEdit();
+	void refreshValue(const void* variable);
+	void recordChange(const EndpointMenuItem* item, const void* old_value,
+			const void* new_value, bool linked);
+	EndpointMenuItem* findItem(uint16_t value_id);
+	bool canSetValue(uint16_t value_id);
+	void setValue(const MenuHistoryEntry& entry, bool undo);
+	void endTransaction(bool commit);
 	void moveCursor(int8_t dir);
-	void changeValue(int8_t dir);
+	void changeValue(int16_t dir);
+	bool jumpTo(uint8_t index, StateInfo::ActionResult result);
+	void moveBy(int16_t rows);
+	void dispatch(MenuAction action, uint8_t count);
 
 public:
-	// MenuController(IMenuFactory& menu, EventQueue& event_queue)
-	// 	: menu_(menu), event_queue_(event_queue) { }
-	MenuController(MenuFactory& menu)
-		: menu_(menu), section_(menu.createRoot()), nav_ctrl_{*this, 2} {
+	/**
+	 * @param cache if given, sections left are kept in it so that navigating
+	 * back to them is faster. It must not be shared between controllers.
+	 * @param visible number of items shown at a time by the display, at least 1
+	 */
+	BasicMenuController(MenuFactory& menu, SectionCache* cache = NULL,
+			uint8_t visible = MENU_VISIBLE_ROWS)
+		: menu_(menu), cache_(cache), section_(menu.createRoot()), nav_ctrl_{*this, visible} {
 		path_.section_id[0] = section_->getId();
 	}
-	~MenuController();
+	~BasicMenuController();
 	void right();
 	void left();
 	void down();
 	void up();
 	void escape();
 	void enter();
+	/** Move the selection one page up, or to the first item */
+	void pageUp();
+	/** Move the selection one page down, or to the last item */
+	void pageDown();
+	/** Select the first item of the section */
+	void home();
+	/** Select the last item of the section */
+	void end();
+	/** Select the item at index of the current section */
+	void seek(uint8_t index);
+	/**
+	 * Go to the section and item of path, e.g. one saved with getPath(). It
+	 * goes up to the last section that both paths share and then down to
+	 * the target, running the onExit callbacks of the sections left. If
+	 * the path turns out to be invalid, it stays at the last section reached
+	 * and the result is MENU_JUMP_FAILED.
+	 */
+	void seek(const Path& path);
+	/**
+	 * Start editing the items of the current section together: accepted
+	 * edits are kept apart, shown but not set, and their onEndEdit callbacks
+	 * are not called, until commit() sets all of them at once. Leaving the
+	 * section rolls the transaction back. Not allowed in edit mode.
+	 * @param on_commit optional callback to validate the new values together
+	 * and to be notified once they are set
+	 */
+	void beginTransaction(OnCommitF* on_commit = NULL);
+	/**
+	 * Set all the new values of the transaction, accepting the edit in
+	 * progress if any, and flush them to the value store. If the callback
+	 * rejects them, the transaction stays open and the result is
+	 * TRANSACTION_FAILED.
+	 */
+	void commit();
+	/** Discard the new values of the transaction, and the edit in progress */
+	void rollback();
+	bool isInTransaction() const { return transaction_.isOpen(); }
+	const MenuTransaction& getTransaction() const { return transaction_; }
+	/**
+	 * Revert the last value change accepted, or all the ones of the last
+	 * transaction committed. Values of the current section are set through
+	 * their items, and the rest through the value registry, if any. The
+	 * onEndEdit callbacks of the items are not called, only the one given to
+	 * setOnUndo(). Not allowed in edit mode or in a transaction.
+	 */
+	void undo();
+	/** Set again the values of the last change undone */
+	void redo();
+	const MenuHistory<MENU_HISTORY_SIZE>& getHistory() const { return history_; }
+	/** Callback for every value set by undo() and redo(), NULL for none */
+	void setOnUndo(OnUndoF* on_undo) { on_undo_ = on_undo; }
+	/**
+	 * Run all the events of the queue, as if the keys were pressed, but
+	 * giving a single StateInfo for all of them so that the menu is drawn once.
+	 * Repeated events are merged: moving the selection n times is a single
+	 * jump, and changing a value n times is a single change of n steps, with
+	 * a single onChange call, clamped to the limits.
+	 * The action result is the one of the last event. If the queue is empty
+	 * nothing changes.
+	 */
+	template<size_t SIZE>
+	void processEvents(MenuEventQueue<SIZE>& queue) {
+		MenuAction action;
+		uint8_t count;
+		if (queue.isEmpty())
+			return;
+		state_.clearDirty();
+		batch_ = true;
+		while (queue.popRun(&action, &count))
+			dispatch(action, count);
+		batch_ = false;
+	}
 	void onPreDraw() { }
 	void onPostDraw() { }
 	const AbstractMenuItem* const * getItems() { return section_->getItems(); }
 	uint8_t getCurrentIndex() { return path_.item_idx[path_.level]; }
 	const AbstractMenuItem* getCurrentItem() { return getCurrentItem_(); }
-	const MenuNavByPages& getNavCtrl() { return nav_ctrl_; };
+	const NavCtrl& getNavCtrl() { return nav_ctrl_; };
+	/**
+	 * Change the number of items shown at a time, e.g. for a different
+	 * display. The whole page is marked dirty.
+	 */
+	void setVisibleRows(uint8_t visible) { nav_ctrl_.setVisible(visible); }
+	uint8_t getVisibleRows() const { return nav_ctrl_.getVisibleRows(); }
+	/**
+	 * Persist the values accepted from now on in store, by their value ID.
+	 * Writes are held by the store and flushed when leaving a section, up or
+	 * down, or when the controller is destroyed.
+	 */
+	void setValueStore(ValueStore* store) { store_ = store; }
+	/** Table of all the values, for undoing changes of other sections */
+	void setValueRegistry(const ValueRegistry* registry) { registry_ = registry; }
 	const Path& getPath() { return path_; }
 	StateInfo& getStateInfo() { return state_; }
+#ifdef MENU_TRACE
+	/** Set the time source of the trace, until then durations are 0 */
+	void setTraceClock(MenuTraceClock clock) { trace_clock_ = clock; }
+	const MenuTrace<MENU_TRACE_SIZE>& getTrace() const { return trace_; }
+#endif
+#ifdef MENU_STATS
+	/** Counters of sections, onExit contexts, formatting and callbacks */
+	const MenuStats& getStats() const { return menuStats(); }
+#endif
 };
 
+typedef BasicMenuController<MenuNavByPages> MenuController;
+typedef BasicMenuController<MenuNavScroll> ScrollMenuController;
+extern template class BasicMenuController<MenuNavByPages>;
+extern template class BasicMenuController<MenuNavScroll>;
+
 //=============================================================================
 // MenuNavByPages
 //=============================================================================
 
-inline MenuNavByPages::MenuNavByPages(MenuController& ctrl, uint8_t visible)
-	: ctrl_(ctrl), visible_(visible) {
+template<class CTRL>
+MenuNavByPages<CTRL>::MenuNavByPages(CTRL& ctrl, uint8_t visible)
+	: ctrl_(ctrl), visible_(visible > 0 ? visible : 1) {
+	setSection();
+}
+
+template<class CTRL>
+void MenuNavByPages<CTRL>::setSection() {
+	uint8_t size = ctrl_.section_->getSize();
+	pages_ = 0;
+	for (uint16_t first = 0; first < size; first += visible_)
+		pages_++;
 	changePage(0);
 }
 
-inline void MenuNavByPages::changePage(uint8_t page) {
+template<class CTRL>
+void MenuNavByPages<CTRL>::changePage(uint8_t page) {
+	page_ = page;
 	first_idx_ = page * visible_;
 
 	uint8_t size = ctrl_.section_->getSize();
@@ -201,23 +569,69 @@ inline void MenuNavByPages::changePage(uint8_t page) {
 	last_idx_ = last_idx_ < size ? last_idx_ : size;
 }
 
-inline const AbstractMenuItem* const * MenuNavByPages::getVisible(uint8_t* size) const {
+template<class CTRL>
+void MenuNavByPages<CTRL>::showCurrent() {
+	uint8_t idx = ctrl_.getCurrentIndex();
+	// first and last pages directly, for home and end
+	if (idx < visible_) {
+		changePage(0);
+		return;
+	}
+	uint8_t last_first = (pages_ - 1) * visible_;
+	if (idx >= last_first) {
+		changePage(pages_ - 1);
+		return;
+	}
+	while (idx >= last_idx_ && page_ + 1 < pages_)
+		changePage(page_ + 1);
+	while (idx < first_idx_)
+		changePage(page_ - 1);
+}
+
+template<class CTRL>
+void MenuNavByPages<CTRL>::setVisible(uint8_t visible) {
+	visible_ = visible > 0 ? visible : 1;
+	setSection();
+	showCurrent();
+	ctrl_.state_.markPage();
+}
+
+template<class CTRL>
+const AbstractMenuItem* const * MenuNavByPages<CTRL>::getVisible(uint8_t* size) const {
 	*size = getCount();
-	// return (&(ctrl_.section_->getItems()[ctrl_.getCurrentIndex() / visible_]));
 	return &(ctrl_.section_->getItems()[first_idx_]);
 }
 
 // show first page
-inline void MenuNavByPages::onSectionDown() {
-	changePage(0);
+template<class CTRL>
+void MenuNavByPages<CTRL>::onSectionDown() {
+	setSection();
+	ctrl_.state_.markPage();
 }
 
 // show previous page
-inline void MenuNavByPages::onSectionUp() {
-	changePage(ctrl_.getCurrentIndex() / visible_);
+template<class CTRL>
+void MenuNavByPages<CTRL>::onSectionUp() {
+	setSection();
+	showCurrent();
+	ctrl_.state_.markPage();
 }
 
-inline void MenuNavByPages::onMoveDown() {
+// redraw everything if the page changed, otherwise the rows left and entered
+template<class CTRL>
+void MenuNavByPages<CTRL>::markMove(uint8_t prev_first, uint8_t prev_row) {
+	if (first_idx_ != prev_first) {
+		ctrl_.state_.markPage();
+	} else {
+		ctrl_.state_.markRow(prev_row, StateInfo::DIRTY_CURSOR);
+		ctrl_.markCurrentRow(StateInfo::DIRTY_CURSOR);
+	}
+}
+
+template<class CTRL>
+void MenuNavByPages<CTRL>::onMoveDown() {
+	uint8_t prev_first = first_idx_;
+	uint8_t prev_row = ctrl_.getCurrentIndex() - first_idx_;
 	ctrl_.setCurrentIndex(ctrl_.getCurrentIndex() + 1);
 	if (ctrl_.getCurrentIndex() == ctrl_.section_->getSize()) {
 		// no more pages - back to top
@@ -228,38 +642,153 @@ inline void MenuNavByPages::onMoveDown() {
 		// down
 		if (ctrl_.getCurrentIndex() == last_idx_) {
 			// next page
-			changePage(ctrl_.getCurrentIndex() / visible_);
+			changePage(page_ + 1);
 		}
 		ctrl_.state_.result_ = StateInfo::ActionResult::MENU_MOVE_DOWN;
 	}
+	markMove(prev_first, prev_row);
 }
 
-inline void MenuNavByPages::onMoveUp() {
+template<class CTRL>
+void MenuNavByPages<CTRL>::onMoveUp() {
+	uint8_t prev_first = first_idx_;
+	uint8_t prev_row = ctrl_.getCurrentIndex() - first_idx_;
 	if (ctrl_.getCurrentIndex() == 0) {
 		// no more pages - go to last
 		ctrl_.setCurrentIndex(ctrl_.section_->getSize() - 1);
-		changePage(ctrl_.getCurrentIndex() / visible_);
+		changePage(pages_ - 1);
 		ctrl_.state_.result_ = StateInfo::ActionResult::MENU_MOVE_BOTTOM;
 	} else {
 		// up
 		ctrl_.setCurrentIndex(ctrl_.getCurrentIndex() - 1);
 		if (ctrl_.getCurrentIndex() < first_idx_) {
 			// previous page
-			changePage(ctrl_.getCurrentIndex() / visible_);
+			changePage(page_ - 1);
 		}
 		ctrl_.state_.result_ = StateInfo::ActionResult::MENU_MOVE_UP;
 	}
+	markMove(prev_first, prev_row);
+}
+
+template<class CTRL>
+void MenuNavByPages<CTRL>::onSeek(uint8_t index) {
+	uint8_t prev_first = first_idx_;
+	uint8_t prev_row = ctrl_.getCurrentIndex() - first_idx_;
+	ctrl_.setCurrentIndex(index);
+	showCurrent();
+	markMove(prev_first, prev_row);
+}
+
+//=============================================================================
+// MenuNavScroll
+//=============================================================================
+
+template<class CTRL>
+void MenuNavScroll<CTRL>::showCurrent() {
+	uint8_t idx = ctrl_.getCurrentIndex();
+	if (idx < first_idx_)
+		first_idx_ = idx;
+	else if (idx >= first_idx_ + visible_)
+		first_idx_ = idx - visible_ + 1;
+	// keep the window full if there are enough items
+	if (getSize() <= visible_)
+		first_idx_ = 0;
+	else if (first_idx_ + visible_ > getSize())
+		first_idx_ = getSize() - visible_;
+}
+
+template<class CTRL>
+void MenuNavScroll<CTRL>::setVisible(uint8_t visible) {
+	visible_ = visible > 0 ? visible : 1;
+	showCurrent();
+	ctrl_.state_.markPage();
+}
+
+template<class CTRL>
+const AbstractMenuItem* const * MenuNavScroll<CTRL>::getVisible(uint8_t* size) const {
+	uint8_t left = getSize() - first_idx_;
+	*size = left < visible_ ? left : visible_;
+	return &(ctrl_.section_->getItems()[first_idx_]);
+}
+
+template<class CTRL>
+void MenuNavScroll<CTRL>::onSectionDown() {
+	first_idx_ = 0;
+	ctrl_.state_.markPage();
+}
+
+template<class CTRL>
+void MenuNavScroll<CTRL>::onSectionUp() {
+	first_idx_ = 0;
+	showCurrent();
+	ctrl_.state_.markPage();
+}
+
+template<class CTRL>
+void MenuNavScroll<CTRL>::onMoveDown() {
+	uint8_t prev_row = ctrl_.getCurrentIndex() - first_idx_;
+	ctrl_.setCurrentIndex(ctrl_.getCurrentIndex() + 1);
+	if (ctrl_.getCurrentIndex() == getSize()) {
+		// back to top, redraw unless the window didn't move
+		ctrl_.setCurrentIndex(0);
+		ctrl_.state_.result_ = StateInfo::ActionResult::MENU_MOVE_TOP;
+		if (first_idx_ != 0) {
+			first_idx_ = 0;
+			ctrl_.state_.markPage();
+			return;
+		}
+	} else {
+		ctrl_.state_.result_ = StateInfo::ActionResult::MENU_MOVE_DOWN;
+		if (ctrl_.getCurrentIndex() == first_idx_ + visible_) {
+			// shift one row up, the new item enters at the bottom
+			first_idx_++;
+			prev_row--;
+			ctrl_.state_.markScroll(1);
+		}
+	}
+	ctrl_.state_.markRow(prev_row, StateInfo::DIRTY_CURSOR);
+	ctrl_.markCurrentRow(StateInfo::DIRTY_CURSOR);
 }
 
-/** Current position in the count -- the page */
-inline uint8_t MenuNavByPages::getPosition() const {
-	return ctrl_.getCurrentIndex() / visible_ + 1;
+template<class CTRL>
+void MenuNavScroll<CTRL>::onMoveUp() {
+	uint8_t prev_row = ctrl_.getCurrentIndex() - first_idx_;
+	if (ctrl_.getCurrentIndex() == 0) {
+		// go to the last item, redraw unless the window didn't move
+		uint8_t prev_first = first_idx_;
+		ctrl_.setCurrentIndex(getSize() - 1);
+		showCurrent();
+		ctrl_.state_.result_ = StateInfo::ActionResult::MENU_MOVE_BOTTOM;
+		if (first_idx_ != prev_first) {
+			ctrl_.state_.markPage();
+			return;
+		}
+	} else {
+		ctrl_.setCurrentIndex(ctrl_.getCurrentIndex() - 1);
+		ctrl_.state_.result_ = StateInfo::ActionResult::MENU_MOVE_UP;
+		if (ctrl_.getCurrentIndex() < first_idx_) {
+			// shift one row down, the new item enters at the top
+			first_idx_--;
+			prev_row++;
+			ctrl_.state_.markScroll(-1);
+		}
+	}
+	ctrl_.state_.markRow(prev_row, StateInfo::DIRTY_CURSOR);
+	ctrl_.markCurrentRow(StateInfo::DIRTY_CURSOR);
 }
 
-/** Total number of pages */
-inline uint8_t MenuNavByPages::getPages() const {
-	// approximation of ceil(size/visible) with integer division
-	return (ctrl_.section_->getSize() + visible_ - 1) / visible_;
+template<class CTRL>
+void MenuNavScroll<CTRL>::onSeek(uint8_t index) {
+	uint8_t prev_first = first_idx_;
+	uint8_t prev_row = ctrl_.getCurrentIndex() - first_idx_;
+	ctrl_.setCurrentIndex(index);
+	showCurrent();
+	if (first_idx_ != prev_first) {
+		ctrl_.state_.markPage();
+	} else {
+		ctrl_.state_.markRow(prev_row, StateInfo::DIRTY_CURSOR);
+		ctrl_.markCurrentRow(StateInfo::DIRTY_CURSOR);
+	}
 }
 
 #endif /* MENU_CONTROLLER_H */
@@ -0,0 +1,91 @@
+/*
+ * File:   menu_events.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:37
+ */
+
+#ifndef MENU_EVENTS_H
+#define MENU_EVENTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "menu_trace.h"
+
+//=============================================================================
+// MenuEventQueue
+//=============================================================================
+
+/**
+ * Queue of key events for the MenuController, so that they can be produced
+ * faster than the menu is drawn, e.g. by an encoder interrupt, and processed
+ * later in a batch with MenuController::processEvents().
+ *
+ * It is a ring buffer with a single producer, which calls push(), and a single
+ * consumer, the controller. Each side only writes its own index, and indices
+ * are 8 bit, so no locks are needed even in 8 bit cores. A compiler barrier
+ * keeps every event written before the index that publishes it, and read
+ * before the index that frees its slot. That is enough between an interrupt
+ * and the main loop of a single core, which is what the queue is meant for.
+ * SIZE must be a power of 2 up to 256. Events pushed while the queue is full
+ * are dropped.
+ */
+template<size_t SIZE>
+class MenuEventQueue {
+    static_assert(SIZE > 1 && SIZE <= 256 && (SIZE & (SIZE - 1)) == 0,
+            "queue size must be a power of 2 up to 256");
+    MenuAction events_[SIZE];
+    volatile uint8_t head_{0}; // next to write, only changed by the producer
+    volatile uint8_t tail_{0}; // next to read, only changed by the consumer
+    volatile uint8_t dropped_{0};
+
+    static uint8_t next(uint8_t idx) { return (idx + 1) & (SIZE - 1); }
+    /** Keep the compiler from moving memory accesses across it */
+    static void barrier() { __asm__ __volatile__("" ::: "memory"); }
+public:
+    /**
+     * Add an event, from the producer side.
+     * @return false if the queue was full and the event was dropped
+     */
+    bool push(MenuAction action) {
+        uint8_t head = head_;
+        if (next(head) == tail_) {
+            if (dropped_ < UINT8_MAX)
+                dropped_ = dropped_ + 1;
+            return false;
+        }
+        events_[head] = action;
+        barrier();
+        head_ = next(head);
+        return true;
+    }
+    /**
+     * Take the next event, from the consumer side, together with the ones
+     * just after it if they are the same.
+     * @param action the event taken
+     * @param count how many times it was repeated, at least 1
+     * @return false if the queue was empty
+     */
+    bool popRun(MenuAction* action, uint8_t* count) {
+        uint8_t tail = tail_;
+        uint8_t head = head_;
+        if (tail == head)
+            return false;
+        barrier();
+        *action = events_[tail];
+        *count = 0;
+        do {
+            tail = next(tail);
+            (*count)++;
+        } while (tail != head && events_[tail] == *action && *count < UINT8_MAX);
+        barrier();
+        tail_ = tail;
+        return true;
+    }
+    bool isEmpty() const { return head_ == tail_; }
+    /** Number of events dropped because the queue was full */
+    uint8_t getDropped() const { return dropped_; }
+    void resetDropped() { dropped_ = 0; }
+};
+
+#endif /* MENU_EVENTS_H */
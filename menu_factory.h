@@ -8,8 +8,11 @@
 #ifndef MENU_FACTORY_H
 #define MENU_FACTORY_H
 
-// forward declaration
-class BaseMenuSection;
+#include <new>
+#include <utility>
+#include "utility.h"
+#include "menu_section.h"
+#include "menu_stats.h"
 
 //=============================================================================
 // MenuFactory
@@ -20,10 +23,74 @@ public:
     virtual ~MenuFactory() = 0;
     virtual BaseMenuSection* createSection(uint16_t section) = 0;
     virtual BaseMenuSection* createRoot() = 0;
+    /**
+     * Destroy a section returned by createSection() or createRoot(), giving its
+     * memory back to wherever the factory took it from.
+     */
+    virtual void destroySection(BaseMenuSection* section) = 0;
+    /** Bytes of memory taken by each section created. */
+    virtual size_t getSectionBytes() const = 0;
 #ifdef DEBUG_MODE
     virtual void onPreDraw() = 0;
 #endif
 };
 inline MenuFactory::~MenuFactory() { }
 
+//=============================================================================
+// SectionArena
+//=============================================================================
+
+/**
+ * Fixed-capacity storage for sections, so that navigating the menu never
+ * touches the heap. It holds SLOTS sections at a time, each slot being as big
+ * as the largest of SECTIONS, which is computed at compile time.
+ *
+ * The MenuController destroys the current section before creating the next
+ * one, so a single slot is enough for it. If it uses a SectionCache, there
+ * should be a slot per section cached too.
+ */
+template<size_t SLOTS, typename... SECTIONS>
+class SectionArena {
+    static const size_t slot_size_ = MaxSizeOf<SECTIONS...>::size;
+    struct Slot {
+        alignas(MaxSizeOf<SECTIONS...>::align) unsigned char mem[slot_size_];
+    };
+    Slot slots_[SLOTS];
+    bool used_[SLOTS]{};
+public:
+    /**
+     * Construct a section of type S in a free slot.
+     * @return the new section, or NULL if all the slots are in use.
+     */
+    template<typename S, typename... ARGS>
+    S* create(ARGS&&... args) {
+        static_assert(sizeof(S) <= slot_size_,
+                "section too big for the arena, add it to the SECTIONS list");
+        static_assert(alignof(S) <= MaxSizeOf<SECTIONS...>::align,
+                "section alignment not supported by the arena");
+        for (size_t i = 0; i < SLOTS; i++) {
+            if (!used_[i]) {
+                used_[i] = true;
+                MENU_STATS_SECTION_CREATED(slot_size_);
+                return new (slots_[i].mem) S(std::forward<ARGS>(args)...);
+            }
+        }
+        return NULL;
+    }
+    /** Destroy a section created by this arena and free its slot. */
+    void destroy(BaseMenuSection* section) {
+        unsigned char* p = (unsigned char*)section;
+        for (size_t i = 0; i < SLOTS; i++) {
+            if (p >= slots_[i].mem && p < slots_[i].mem + slot_size_) {
+                section->~BaseMenuSection();
+                used_[i] = false;
+                MENU_STATS_SECTION_DESTROYED(slot_size_);
+                return;
+            }
+        }
+    }
+    /** Size in bytes of each slot. */
+    static constexpr size_t getSlotSize() { return slot_size_; }
+};
+
 #endif
@@ -0,0 +1,101 @@
+/*
+ * File:   menu_history.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:46
+ */
+
+#ifndef MENU_HISTORY_H
+#define MENU_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include "menu_item.h"
+
+/** Number of value changes that a MenuController can undo */
+#ifndef MENU_HISTORY_SIZE
+#define MENU_HISTORY_SIZE 8
+#endif
+
+//=============================================================================
+// MenuHistory
+//=============================================================================
+
+/** A change of the value with an ID */
+struct MenuHistoryEntry {
+    ValueUnion old_value;
+    ValueUnion new_value;
+    uint16_t value_id;
+    uint8_t size; // bytes of the values
+    bool linked; // undone and redone together with the previous entry
+};
+
+/**
+ * Ring buffer with the last SIZE value changes, for undoing and redoing them.
+ * Entries are kept in order, the ones before the cursor can be undone, and the
+ * ones after it redone. Recording a change discards the ones that could be
+ * redone, and once full, the oldest one.
+ *
+ * Changes recorded together, e.g. the values of a transaction, are linked so
+ * that they are undone and redone at once. A group bigger than SIZE keeps only
+ * its last entries.
+ */
+template<size_t SIZE>
+class MenuHistory {
+    static_assert(SIZE > 0 && SIZE < UINT8_MAX, "history size must be 1 to 254");
+    MenuHistoryEntry entries_[SIZE];
+    uint8_t first_{0}; // oldest entry
+    uint8_t count_{0}; // entries kept
+    uint8_t cursor_{0}; // entries that can be undone
+
+    uint8_t index(uint8_t i) const { return first_ + i >= SIZE ? first_ + i - SIZE : first_ + i; }
+    MenuHistoryEntry& at(uint8_t i) { return entries_[index(i)]; }
+    const MenuHistoryEntry& at(uint8_t i) const { return entries_[index(i)]; }
+public:
+    void record(const MenuHistoryEntry& entry) {
+        count_ = cursor_;
+        if (count_ == SIZE) {
+            first_ = first_ + 1 == SIZE ? 0 : first_ + 1;
+            count_--;
+            // the rest of a group that lost its first entry cannot be undone
+            while (count_ > 0 && at(0).linked) {
+                first_ = first_ + 1 == SIZE ? 0 : first_ + 1;
+                count_--;
+            }
+        }
+        at(count_++) = entry;
+        cursor_ = count_;
+    }
+    bool canUndo() const { return cursor_ > 0; }
+    bool canRedo() const { return cursor_ < count_; }
+    /**
+     * Number of entries of the group to be undone next, the last of them being
+     * getUndo(0), or 0 if there is none.
+     */
+    uint8_t getUndoCount() const {
+        uint8_t n = 0;
+        while (n < cursor_ && at(cursor_ - 1 - n).linked)
+            n++;
+        return n < cursor_ ? n + 1 : n;
+    }
+    /** Entry i of the group to be undone next, counting back from the last */
+    const MenuHistoryEntry& getUndo(uint8_t i) const { return at(cursor_ - 1 - i); }
+    /** Number of entries of the group to be redone next, or 0 if there is none */
+    uint8_t getRedoCount() const {
+        if (cursor_ == count_)
+            return 0;
+        uint8_t n = 1;
+        while (cursor_ + n < count_ && at(cursor_ + n).linked)
+            n++;
+        return n;
+    }
+    /** Entry i of the group to be redone next */
+    const MenuHistoryEntry& getRedo(uint8_t i) const { return at(cursor_ + i); }
+    /** Move the cursor back n entries, once undone */
+    void undone(uint8_t n) { cursor_ -= n; }
+    /** Move the cursor forward n entries, once redone */
+    void redone(uint8_t n) { cursor_ += n; }
+    void clear() { first_ = count_ = cursor_ = 0; }
+};
+
+#endif /* MENU_HISTORY_H */
@@ -0,0 +1,170 @@
+/*
+ * File:   menu_index.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:36
+ */
+
+#ifndef MENU_INDEX_H
+#define MENU_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include "menu_controller.h"
+#include "menu_factory.h"
+#include "menu_item.h"
+#include "menu_section.h"
+
+//=============================================================================
+// MenuIndex
+//=============================================================================
+
+/**
+ * Index of the labels of all the items of a menu, for finding items by the
+ * beginning of their label without going through the sections. It is built
+ * once by walking the menu tree, which instantiates every section one time,
+ * and after that searching and jumping to the results do not need any of them.
+ *
+ * Every item is kept with its section, and the link item through which its
+ * section was reached first, so that the path to it can be rebuilt. Sections
+ * reachable through several links, or links back up the tree, are indexed only
+ * once, and so are the sections deeper than the controller can go.
+ *
+ * Labels are kept as pointers, so they must be static strings, as they usually
+ * are. It holds up to N items, each of them taking an entry in RAM of 10 bytes
+ * on the AVR, 16 on a 64 bit PC.
+ *
+ * The index cannot be generated when compiling, as the items only exist once
+ * their section is constructed, so it is built at run time instead. That
+ * needs a free slot in the factory while building, see build().
+ */
+template<size_t N, uint8_t DEPTH = MAX_MENU_DEPTH>
+class MenuIndex {
+    static_assert(N < UINT16_MAX, "too many entries for 16 bit indices");
+public:
+    static const uint16_t NOT_FOUND = UINT16_MAX;
+private:
+    struct Entry {
+        const char* label;
+        uint16_t section; // section of the item
+        uint16_t target; // section linked by the item, NOT_FOUND for values
+        uint16_t parent; // entry of the link to the section, NOT_FOUND for root
+        uint8_t item; // index in the section
+        uint8_t level; // level of the section in the menu
+    };
+    Entry entries_[N];
+    uint16_t count_{0};
+    uint16_t root_{0};
+
+    /** Whether the section is already in the index */
+    bool isIndexed(uint16_t section, uint16_t link) const {
+        if (section == root_)
+            return true;
+        for (uint16_t i = 0; i < link; i++) {
+            if (entries_[i].target == section && entries_[i].level + 1 < DEPTH)
+                return true;
+        }
+        return false;
+    }
+    /**
+     * Add the items of the section, reached through the link entry parent.
+     * @return false if the index is full
+     */
+    bool addSection(BaseMenuSection* section, uint16_t parent, uint8_t level) {
+        AbstractMenuItem** items = section->getItems();
+        for (uint8_t i = 0; i < section->getSize(); i++) {
+            if (count_ == N)
+                return false;
+            uint16_t target = NOT_FOUND;
+            if (items[i]->isSection())
+                target = ((SectionMenuItem*)items[i])->getSectionId();
+            entries_[count_++] = {items[i]->getInfoStringPtr(), (uint16_t)section->getId(),
+                    target, parent, i, level};
+        }
+        return true;
+    }
+    static char toLower(char c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+    static bool startsWith(const char* label, const char* prefix) {
+        for (; *prefix; label++, prefix++) {
+            if (toLower(*label) != toLower(*prefix))
+                return false;
+        }
+        return true;
+    }
+public:
+    /**
+     * Walk the menu indexing every item. Each section is created and destroyed
+     * in turn, so the factory must have a free slot, e.g. build the index
+     * before creating the controller.
+     * @return false if the index was too small or a section could not be
+     * created, in which case it holds the items found until then.
+     */
+    bool build(MenuFactory& menu) {
+        count_ = 0;
+        BaseMenuSection* root = menu.createRoot();
+        if (!root)
+            return false;
+        root_ = root->getId();
+        bool ok = addSection(root, NOT_FOUND, 0);
+        menu.destroySection(root);
+        // sections in order of distance to the root, the entries being the queue
+        for (uint16_t i = 0; ok && i < count_; i++) {
+            const Entry& link = entries_[i];
+            if (link.target == NOT_FOUND || link.level + 1 >= DEPTH
+                    || isIndexed(link.target, i))
+                continue;
+            BaseMenuSection* section = menu.createSection(link.target);
+            if (!section)
+                return false;
+            ok = addSection(section, i, link.level + 1);
+            menu.destroySection(section);
+        }
+        return ok;
+    }
+    /**
+     * Find the next item whose label starts with prefix, ignoring case.
+     * @param from first entry to look at, e.g. the last result plus one to get
+     * the next one
+     * @return the entry found, or NOT_FOUND
+     */
+    uint16_t find(const char* prefix, uint16_t from = 0) const {
+        for (uint16_t i = from; i < count_; i++) {
+            if (startsWith(entries_[i].label, prefix))
+                return i;
+        }
+        return NOT_FOUND;
+    }
+    /**
+     * Fill the path from the root to the item of an entry, as used by the
+     * controller, e.g. for MenuController::seek().
+     */
+    template<typename PATH>
+    void getPath(uint16_t entry, PATH& path) const {
+        const Entry* e = &entries_[entry];
+        path.level = e->level;
+        for (;;) {
+            path.section_id[e->level] = e->section;
+            path.item_idx[e->level] = e->item;
+            if (e->parent == NOT_FOUND)
+                break;
+            e = &entries_[e->parent];
+        }
+    }
+    /**
+     * Make the controller go to the item of an entry.
+     * @return whether it got there
+     */
+    template<typename CTRL>
+    bool seek(CTRL& ctrl, uint16_t entry) const {
+        if (entry >= count_)
+            return false;
+        typename CTRL::Path path;
+        getPath(entry, path);
+        ctrl.seek(path);
+        return ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::MENU_JUMP;
+    }
+    const char* getLabel(uint16_t entry) const { return entries_[entry].label; }
+    uint16_t getCount() const { return count_; }
+};
+
+#endif /* MENU_INDEX_H */
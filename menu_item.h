@@ -9,12 +9,13 @@
 #define MENU_ITEM_H
 
 #include <string.h>
-#include <stdio.h>
 #include <cstdint>
 #include <cfloat>
 #include <climits>
+#include <type_traits>
 #include "functors.h"
 #include "utility.h"
+#include "menu_stats.h"
 
 typedef unsigned int uint;
 
@@ -22,26 +23,90 @@ static OnStartEditNOP onStartEditNOP;
 static OnEndEditNOP onEndEditNOP;
 static OnChangeNOP onChangeNOP;
 
+/**
+ * Define MENU_WIDE_VALUES to enable the items of 64 bit types, Int64MenuItem
+ * and Float64MenuItem. It doubles the size of every ValueUnion, used by the
+ * edit, transaction and history buffers and the value store records, so it is
+ * off by default.
+ */
+#ifdef MENU_WIDE_VALUES
+typedef MaxSizeOf<int32_t, uint16_t, uint32_t, float, bool, int64_t, double> MenuValueTypes;
+#else
+typedef MaxSizeOf<int32_t, uint16_t, uint32_t, float, bool> MenuValueTypes;
+#endif
+
 /**
  * Number of bytes of the biggest data type that a menu item must be able to
- * hold. Currently it's 4 bytes for 32 bit integers, float and double types in
- * AVR atmega-2560.
+ * hold, 4 bytes for 32 bit integers and float, or 8 with MENU_WIDE_VALUES.
+ * double is 4 bytes in AVR atmega-2560 anyway.
+ */
+#define MAX_MENU_ITEM_VALUE_BYTES (MenuValueTypes::size)
+
+/**
+ * Define MENU_STATIC_DISPATCH to call the item implementations through a
+ * switch on their MenuItemType instead of through virtual functions. Items then
+ * have no vtable pointer, which saves RAM per item and avoids indirect calls,
+ * but only the item classes with a MenuItemType tag can be used.
  */
-#define MAX_MENU_ITEM_VALUE_BYTES 4
+#ifdef MENU_STATIC_DISPATCH
+#define MENU_ITEM_OVERRIDE
+#else
+#define MENU_ITEM_OVERRIDE override
+#endif
+
+/**
+ * Define MENU_VALUE_STRING_CACHE to keep in every item the string representation
+ * of its value, so that it's formatted again only after the value changes. It
+ * costs MENU_VALUE_STRING_CACHE_BYTES of RAM per item, 16 by default or 32 with
+ * MENU_WIDE_VALUES, which also limits the length of the strings cached. Buffers
+ * smaller than that are formatted every time. Variables wrapped by items that are modified from outside the menu
+ * require a call to EndpointMenuItem::invalidateValueString().
+ */
+#ifndef MENU_VALUE_STRING_CACHE_BYTES
+#ifdef MENU_WIDE_VALUES
+// "-" + 18 digits + "." + 9 decimals, the widest Float64MenuItem
+#define MENU_VALUE_STRING_CACHE_BYTES 32
+#else
+#define MENU_VALUE_STRING_CACHE_BYTES 16
+#endif
+#endif
 
 /**
  * Types of menu items for down-casting when required.
  */
-enum class MenuItemType {
+enum class MenuItemType : uint8_t {
     section,
     int32,
     uint16,
     float32,
     sel8u,
     sel32u,
-    boolean
+    boolean,
+    fixed32,
+    uint32,
+    int64,
+    float64
 };
 
+/**
+ * Size in bytes of the variable wrapped by the items of a type, 0 for sections.
+ */
+inline uint8_t menuItemValueSize(MenuItemType type) {
+    switch (type) {
+    case MenuItemType::int32: return sizeof(int32_t);
+    case MenuItemType::uint16: return sizeof(uint16_t);
+    case MenuItemType::float32: return sizeof(float);
+    case MenuItemType::fixed32: return sizeof(int32_t);
+    case MenuItemType::sel8u: return sizeof(uint8_t);
+    case MenuItemType::sel32u: return sizeof(uint32_t);
+    case MenuItemType::boolean: return sizeof(bool);
+    case MenuItemType::uint32: return sizeof(uint32_t);
+    case MenuItemType::int64: return sizeof(int64_t);
+    case MenuItemType::float64: return sizeof(double);
+    default: return 0;
+    }
+}
+
 //=============================================================================
 // AbstractMenuItem
 //=============================================================================
@@ -51,16 +116,30 @@ enum class MenuItemType {
  * virtual interface for navigation, and querying of basic info.
  */
 class AbstractMenuItem {
-    const MenuItemType type_;
-    bool active_;
+    /*
+     * Fields are ordered from bigger to smaller, so that the small ones share
+     * the padding at the end with the first fields of derived classes.
+     */
     const char *info_string_;
+    const MenuItemType type_;
+protected:
+    /** Bit-packed boolean properties of the item */
+    enum : uint8_t {
+        FLAG_ACTIVE = 0x01,
+        FLAG_CURSOR = 0x02 // used by EndpointMenuItem
+    };
+    uint8_t flags_;
 public:
     AbstractMenuItem(MenuItemType type, bool active, const char *info_str)
-        : type_(type)
-        , active_(active)
-        , info_string_(info_str) { }
+        : info_string_(info_str)
+        , type_(type)
+        , flags_(active ? FLAG_ACTIVE : 0) { }
     AbstractMenuItem(const AbstractMenuItem& other);
+#ifdef MENU_STATIC_DISPATCH
+    ~AbstractMenuItem() { }
+#else
     virtual ~AbstractMenuItem() = 0;
+#endif
     /**
      * Get item display name
      * @param buf destination buffer to copy the info string to
@@ -69,6 +148,8 @@ public:
     void getInfoString(char *buf, size_t sz) const {
         strncpy(buf, info_string_, sz);
     }
+    /** Item display name itself, which is a static string */
+    const char* getInfoStringPtr() const { return info_string_; }
     /**
      * Get item type - for static conversions
      * @return the type of this item
@@ -76,11 +157,13 @@ public:
     MenuItemType getType() const { return type_; }
     /** For convenience */
     bool isSection() const { return type_ == MenuItemType::section; }
-    bool isActive() const { return active_; }
+    bool isActive() const { return flags_ & FLAG_ACTIVE; }
     /** Enable/disable item for down-navigation or editing, depending on the type */
-    void setActive(bool b) { active_ = b; }
+    void setActive(bool b) { flags_ = b ? flags_ | FLAG_ACTIVE : flags_ & ~FLAG_ACTIVE; }
 };
+#ifndef MENU_STATIC_DISPATCH
 inline AbstractMenuItem::~AbstractMenuItem() { }
+#endif
 
 //=============================================================================
 // SectionMenuItem
@@ -94,7 +177,7 @@ public:
     SectionMenuItem(uint16_t section_id, bool active, const char *info_str)
         : AbstractMenuItem(MenuItemType::section, active, info_str)
         , section_id_(section_id) { }
-    ~SectionMenuItem() override { }
+    ~SectionMenuItem() MENU_ITEM_OVERRIDE { }
     uint16_t getSectionId() const { return section_id_; };
 private:
     uint16_t section_id_;
@@ -109,12 +192,31 @@ private:
  * that can fit in it, in order to be able to restore the value in case of
  * editing cancellation.
  * It is similar to a union but we can avoid type checking for later convenience
- * in MenuItem classes.
+ * in MenuItem classes. Items copy only the bytes of their type into and out of
+ * it.
  */
 struct ValueUnion {
-	char mem[MAX_MENU_ITEM_VALUE_BYTES];
+	alignas(MenuValueTypes::align) char mem[MAX_MENU_ITEM_VALUE_BYTES];
+};
+
+//=============================================================================
+// ValueStringCacheStats
+//=============================================================================
+
+/**
+ * Hit and miss counters of the value string cache of all the items.
+ */
+struct ValueStringCacheStats {
+    uint32_t hits;
+    uint32_t misses;
 };
 
+/** Global instance, shared by all translation units */
+inline ValueStringCacheStats& valueStringCacheStats() {
+    static ValueStringCacheStats stats{0, 0};
+    return stats;
+}
+
 //=============================================================================
 // EndpointMenuItem
 //=============================================================================
@@ -127,45 +229,77 @@ struct ValueUnion {
  * actual class of the object.
  */
 class EndpointMenuItem : public AbstractMenuItem {
+    // fits in the padding at the end of AbstractMenuItem
+    const uint16_t value_id_;
 protected:
     void *data_;
 private:
-    const uint16_t value_id_;
-    // Whether the value is editable digit-wise and therefore a cursor must be shown.
-    const bool cursor_;
     OnStartEditF& onStartEdit_;
     OnEndEditF& onEndEdit_;
     OnChangeF& onChange_;
+#ifdef MENU_VALUE_STRING_CACHE
+    mutable char value_str_[MENU_VALUE_STRING_CACHE_BYTES];
+    mutable bool value_str_valid_{false};
+#endif
 public:
+    /**
+     * @param cursor whether the value is editable digit-wise and therefore a
+     * cursor must be shown.
+     */
     EndpointMenuItem(MenuItemType type, bool active, const char *info_str, void *value,
             OnStartEditF& f, OnEndEditF& g, OnChangeF& h, uint16_t value_id,
             bool cursor)
         : AbstractMenuItem(type, active, info_str)
-        , data_(value)
         , value_id_(value_id)
-		, cursor_(cursor)
+        , data_(value)
         , onStartEdit_(f)
         , onEndEdit_(g)
-        , onChange_(h) { }
+        , onChange_(h) {
+        if (cursor)
+            flags_ |= FLAG_CURSOR;
+    }
     // EndpointMenuItem(const EndpointMenuItem& orig);
+#ifdef MENU_STATIC_DISPATCH
+    ~EndpointMenuItem() { }
+#else
     virtual ~EndpointMenuItem() = 0;
+#endif
 	/** Get the string representation of the value wrapped by the item */
-    virtual void getValueAsString(char *buf, size_t sz) const = 0;
+    void getValueAsString(char *buf, size_t sz) const;
+	/**
+	 * Discard the cached string representation of the value, if any. Derived
+	 * classes must call it whenever they change the value.
+	 */
+    void invalidateValueString() {
+#ifdef MENU_VALUE_STRING_CACHE
+        value_str_valid_ = false;
+#endif
+    }
 	/* These 4 functions are used by the TempMenuItem */
-    void * getValuePointer() { return data_; }
-    void setValuePointer(void *value) { data_ = value; }
-	virtual void setValueUnion(ValueUnion* value) = 0;
-	virtual ValueUnion getValueUnion() const = 0;
+    void * getValuePointer() const { return data_; }
+    void setValuePointer(void *value) {
+        data_ = value;
+        invalidateValueString();
+    }
+	void setValueUnion(ValueUnion* value);
+	ValueUnion getValueUnion() const;
+	/**
+	 * Number of digits of the value that can be selected with the cursor, which
+	 * is computed arithmetically without formatting the value.
+	 */
+    uint8_t getDigitCount() const;
 	/**
 	 * Change the value wrapped by this menu item.
 	 * @param digit the digit to be changed, if the item is cursor editable.
-	 * Digit 0 is the lowest.
-	 * @param direction true is up, false is down
+	 * Digit 0 is the lowest one shown, including decimals.
+	 * @param direction >= 0 is up, < 0 is down. Its magnitude is the number of
+	 * steps, e.g. of repeated key presses, 0 being one as well
 	 * @return whether the change was successful. If not, limits have been reached.
 	 */
-    bool changeValue(uint8_t digit, int8_t direction) {
-        if (changeValue_(digit, direction)) {
-            onChange_(*this);
+    bool changeValue(uint8_t digit, int16_t direction) {
+        if (dispatchChangeValue(digit, direction)) {
+            invalidateValueString();
+            onChange();
             return true;
         }
         return false;
@@ -175,22 +309,54 @@ public:
 	 * value stored in EEPROM after an accepted change.
 	 */
     uint16_t getValueStorageId() const { return value_id_; }
+    /** Size in bytes of the variable wrapped, e.g. for storing it */
+    uint8_t getValueSize() const { return menuItemValueSize(getType()); }
 	/**
 	 * Whether the item can be edited freely with a cursor, or otherwise in
 	 * fixed steps.
 	 */
-    bool isCursorEditable() const { return cursor_; }
-    void onChange() { onChange_(*this); }
-    void onStartEdit() { onStartEdit_(*this); }
-    void onEndEdit() { onEndEdit_(*this); }
+    bool isCursorEditable() const { return flags_ & FLAG_CURSOR; }
+    void onChange() {
+        MENU_STATS_INC(callback_calls);
+        onChange_(*this);
+    }
+    void onStartEdit() {
+        MENU_STATS_INC(callback_calls);
+        onStartEdit_(*this);
+    }
+    void onEndEdit() {
+        MENU_STATS_INC(callback_calls);
+        onEndEdit_(*this);
+    }
+protected:
+    /** Number of steps of a direction of changeValue() */
+    static uint16_t stepCount(int16_t direction) {
+        return direction < 0 ? -direction : direction > 0 ? direction : 1;
+    }
+private:
+    void dispatchGetValueAsString(char *buf, size_t sz) const;
+    bool dispatchChangeValue(uint8_t digit, int16_t direction);
+#ifndef MENU_STATIC_DISPATCH
 protected:
+    /*
+     * Implementations of the public interface to be provided by derived
+     * classes. They are virtual unless MENU_STATIC_DISPATCH is defined, in
+     * which case derived classes must still provide them with these names.
+     */
+    virtual void getValueAsString_(char *buf, size_t sz) const = 0;
+    virtual void setValueUnion_(ValueUnion* value) = 0;
+    virtual ValueUnion getValueUnion_() const = 0;
+    virtual uint8_t getDigitCount_() const = 0;
     /**
      * Override this so that onChange callback is automatically called. Returns
      * true if the value was changed, false if trying to pass through limits.
      */
-    virtual bool changeValue_(uint8_t digit, int8_t direction) = 0;
+    virtual bool changeValue_(uint8_t digit, int16_t direction) = 0;
+#endif
 };
+#ifndef MENU_STATIC_DISPATCH
 inline EndpointMenuItem::~EndpointMenuItem() { }
+#endif
 
 //=============================================================================
 // IntegerRangeDefVal
@@ -217,12 +383,28 @@ struct IntegerRangeDefVal<uint16_t> {
     static const uint16_t max = UINT16_MAX;
 };
 
+/** Template specialization */
+template<>
+struct IntegerRangeDefVal<uint32_t> {
+    static const uint32_t min = 0;
+    static const uint32_t max = UINT32_MAX;
+};
+
+/** Template specialization */
+template<>
+struct IntegerRangeDefVal<int64_t> {
+    static const int64_t min = INT64_MIN;
+    static const int64_t max = INT64_MAX;
+};
+
 //=============================================================================
 // IntegerMenuItem
 //=============================================================================
 
 template<typename T, MenuItemType item_type>
 class IntegerMenuItem : public EndpointMenuItem {
+    static_assert(sizeof(T) <= MAX_MENU_ITEM_VALUE_BYTES,
+            "value type bigger than ValueUnion, see MENU_WIDE_VALUES");
 public:
     /**
      * Range specification structure. Default values are chosen statically
@@ -247,7 +429,7 @@ public:
         , range_(range) { }
 
     IntegerMenuItem(bool active, const char* info_str, T* value, const RangeSpec& range, uint16_t value_id)
-        : IntegerMenuItem(active, info_str, (void*)value, range, onStartEditNOP,
+        : IntegerMenuItem(active, info_str, value, range, onStartEditNOP,
 				onEndEditNOP, onChangeNOP, value_id) {}
     /**
     * Shorter constructor that uses default init for range specs, which chooses
@@ -258,52 +440,70 @@ public:
         : EndpointMenuItem(item_type, active, info_str, (void*)value, f, g, h,
                 value_id, true) { }
 
-    ~IntegerMenuItem() override { }
+    ~IntegerMenuItem() MENU_ITEM_OVERRIDE { }
 
-    void getValueAsString(char* buf, size_t sz) const override {
-        snprintf(buf, sz, "%d", *(T*)data_);
+    void getValueAsString_(char* buf, size_t sz) const MENU_ITEM_OVERRIDE {
+        intToDec(buf, sz, *(T*)data_);
     }
 
     /**
      * Increase or decrease the value of the variable wrapped by the item. If
-     * step==0 add/substract 10^digit, otherwise use the ammount stored in step.
-     * If the value is not at the limits, do the operation and clamp to them,
+     * step==0 add/substract 10^digit, otherwise use the ammount stored in step,
+     * once per step of the direction. If the value is not at the limits, do the operation and clamp to them,
      * returning true. If already at the limits, do nothign and return false.
      */
-    bool changeValue_(uint8_t digit, int8_t direction) override {
+    bool changeValue_(uint8_t digit, int16_t direction) MENU_ITEM_OVERRIDE {
 		T& value = *(T*)data_;
-        if (value == range_.max && direction)
+        if (value == range_.max && direction >= 0)
             return false;
-        if (value == range_.min && !direction)
+        if (value == range_.min && direction < 0)
             return false;
 
         T step = range_.step;
         if (step == 0)
-            step = base10pow(digit);
-
-        if (direction >= 0)
-            value += step;
-        else
-            value -= step;
+            step = sizeof(T) > sizeof(int32_t) ? (T)base10pow64(digit) : (T)base10pow(digit);
 
+        // compare the steps with the distance to the limit before operating,
+        // so that the value never wraps or overflows. The distance is taken
+        // unsigned, as it may not fit in T when the range spans all of it
+        typedef typename std::make_unsigned<T>::type U;
+        U steps = stepCount(direction);
         if (value > range_.max)
             value = range_.max;
-
-        if (value < range_.min)
+        else if (value < range_.min)
             value = range_.min;
+        else if (direction >= 0)
+            value = (U)(range_.max - (U)value) / (U)step < steps ? range_.max
+                    : (T)((U)value + (U)step * steps);
+        else
+            value = (U)((U)value - range_.min) / (U)step < steps ? range_.min
+                    : (T)((U)value - (U)step * steps);
 
         return true;
     }
 
+    uint8_t getDigitCount_() const MENU_ITEM_OVERRIDE { return intDigits(*(T*)data_); }
+
     T getValue() const { return *(T*)data_; }
-    void setValue(T value) { *(T*)data_ = value; }
-	void setValueUnion(ValueUnion* value) override { *(T*)data_ = *(T*)value; }
-	ValueUnion getValueUnion() const override { return *(ValueUnion*)data_; }
+    void setValue(T value) {
+        *(T*)data_ = value;
+        invalidateValueString();
+    }
+	void setValueUnion_(ValueUnion* value) MENU_ITEM_OVERRIDE { memcpy(data_, value, sizeof(T)); }
+	ValueUnion getValueUnion_() const MENU_ITEM_OVERRIDE {
+		ValueUnion value{};
+		memcpy(&value, data_, sizeof(T));
+		return value;
+	}
 };
 
 /** Aliases for convenience */
 typedef IntegerMenuItem<int32_t, MenuItemType::int32> Int32MenuItem;
 typedef IntegerMenuItem<uint16_t, MenuItemType::uint16> Uint16MenuItem;
+typedef IntegerMenuItem<uint32_t, MenuItemType::uint32> Uint32MenuItem;
+#ifdef MENU_WIDE_VALUES
+typedef IntegerMenuItem<int64_t, MenuItemType::int64> Int64MenuItem;
+#endif
 
 //=============================================================================
 // SelectionMenuItem
@@ -317,10 +517,29 @@ typedef IntegerMenuItem<uint16_t, MenuItemType::uint16> Uint16MenuItem;
  */
 template<typename T, MenuItemType item_type>
 class SelectionMenuItem : public EndpointMenuItem {
+    static_assert(sizeof(T) <= MAX_MENU_ITEM_VALUE_BYTES,
+            "value type bigger than ValueUnion, see MENU_WIDE_VALUES");
     const char * const* labels_;
     const T* values_;
     const uint8_t count_;
-    uint8_t index_{0};
+    mutable uint8_t index_{0};
+    mutable T synced_; // value of the variable when index_ was last looked up
+    void findIndex(T value) const {
+        synced_ = value;
+        for (uint8_t i = 0; i < count_; i++) {
+            if (values_[i] == value)
+                index_ = i;
+        }
+    }
+    /**
+     * Find the index again if the wrapped variable was changed from outside,
+     * e.g. by another item while this one was kept in a SectionCache. A value
+     * that is not in the list is only looked up once.
+     */
+    void syncIndex() const {
+        if (synced_ != *(T*)data_)
+            findIndex(*(T*)data_);
+    }
 public:
 	SelectionMenuItem(bool active, const char* info_string, T* value,
 			const char * const* labels, const T* values, uint8_t count,
@@ -336,23 +555,21 @@ public:
 		: SelectionMenuItem(active, info_string, value, labels, values, count,
 				onStartEditNOP, onEndEditNOP, onChangeNOP, value_id) {}
 
-	void getValueAsString(char* buf, size_t sz) const override {
+	void getValueAsString_(char* buf, size_t sz) const MENU_ITEM_OVERRIDE {
+        syncIndex();
         strncpy(buf, labels_[index_], sz);
     }
-    bool changeValue_(uint8_t digit, int8_t direction) {
+    bool changeValue_(uint8_t digit, int16_t direction) MENU_ITEM_OVERRIDE {
+        syncIndex();
         // increase/decrease with wrap-around
-        if (direction >= 0) {
-            index_++;
-            if (index_ == count_)
-                index_ = 0;
-        } else {
-            if (index_ == 0)
-                index_ = count_ - 1;
-            else
-                index_--;
-        }
+        uint8_t steps = stepCount(direction) % count_;
+        if (direction >= 0)
+            index_ = index_ + steps >= count_ ? index_ + steps - count_ : index_ + steps;
+        else
+            index_ = index_ < steps ? index_ + count_ - steps : index_ - steps;
         // update the destination variable
         *(T*)data_ = values_[index_];
+        synced_ = values_[index_];
         return true;
     }
     T getValue() const { return *(T*)data_; }
@@ -360,19 +577,26 @@ public:
 		values = values_;
 		sz = count_;
 	}
+    uint8_t getDigitCount_() const MENU_ITEM_OVERRIDE { return 1; }
     uint8_t getIndex() const { return index_; }
 	void setValue(T value) {
         // search for the current value
-        for (uint8_t i = 0; i < count_; i++) {
-            if (values_[i] == value)
-                index_ = i;
-        }
+        findIndex(value);
+        invalidateValueString();
         // TODO: consider adding some sort of assertion to warn when value is
         // not found in values_
 	}
-    void setValueIdx(uint8_t index) { index_ = index < count_ ? index : index_; }
-	void setValueUnion(ValueUnion* value) override { *(T*)data_ = *(T*)value; }
-	ValueUnion getValueUnion() const override { return *(ValueUnion*)data_; }
+    void setValueIdx(uint8_t index) {
+        index_ = index < count_ ? index : index_;
+        synced_ = values_[index_]; // looked up again if the variable differs
+        invalidateValueString();
+    }
+	void setValueUnion_(ValueUnion* value) MENU_ITEM_OVERRIDE { memcpy(data_, value, sizeof(T)); }
+	ValueUnion getValueUnion_() const MENU_ITEM_OVERRIDE {
+		ValueUnion value{};
+		memcpy(&value, data_, sizeof(T));
+		return value;
+	}
 };
 
 /** Aliases for convenience */
@@ -392,20 +616,30 @@ public:
     BoolMenuItem(bool active, const char* info_string, bool* value, uint16_t value_id)
         : EndpointMenuItem(MenuItemType::boolean, active, info_string, (void*)value,
                 onStartEditNOP, onEndEditNOP, onChangeNOP, value_id, false) {}
-    void getValueAsString(char* buf, size_t sz) const override {
+    void getValueAsString_(char* buf, size_t sz) const MENU_ITEM_OVERRIDE {
         if (*(bool*)data_)
             strncpy(buf, "On", sz);
         else
             strncpy(buf, "Off", sz);
     }
-    bool changeValue_(uint8_t digit, int8_t direction) {
-        *(bool*)data_ = *(bool*)data_ ? false : true;
+    bool changeValue_(uint8_t digit, int16_t direction) MENU_ITEM_OVERRIDE {
+        // every step toggles it
+        if (stepCount(direction) % 2)
+            *(bool*)data_ = *(bool*)data_ ? false : true;
         return true;
     }
+    uint8_t getDigitCount_() const MENU_ITEM_OVERRIDE { return 1; }
     bool getValue() const { return *(bool*)data_; }
-    void setValue(bool value) { *(bool*)data_ = value; }
-	void setValueUnion(ValueUnion* value) override { *(bool*)data_ = *(bool*)value; }
-	ValueUnion getValueUnion() const override { return *(ValueUnion*)data_; }
+    void setValue(bool value) {
+        *(bool*)data_ = value;
+        invalidateValueString();
+    }
+	void setValueUnion_(ValueUnion* value) MENU_ITEM_OVERRIDE { memcpy(data_, value, sizeof(bool)); }
+	ValueUnion getValueUnion_() const MENU_ITEM_OVERRIDE {
+		ValueUnion value{};
+		memcpy(&value, data_, sizeof(bool));
+		return value;
+	}
 };
 
 //=============================================================================
@@ -439,6 +673,8 @@ struct DecimalRangeDefVal<double> {
 
 template<typename T, MenuItemType item_type>
 class DecimalMenuItem : public EndpointMenuItem {
+    static_assert(sizeof(T) <= MAX_MENU_ITEM_VALUE_BYTES,
+            "value type bigger than ValueUnion, see MENU_WIDE_VALUES");
 public:
     /**
      * Range specification structure. Default values are chosen statically
@@ -477,34 +713,34 @@ public:
         : EndpointMenuItem(item_type, active, info_str, (void*)value, f, g, h, value_id, true)
         , precision_(precision) { }
 
-    ~DecimalMenuItem() override { }
+    ~DecimalMenuItem() MENU_ITEM_OVERRIDE { }
 
-    void getValueAsString(char* buf, size_t sz) const override {
+    void getValueAsString_(char* buf, size_t sz) const MENU_ITEM_OVERRIDE {
         ftoaFix(buf, sz, *(T*)data_, precision_);
     }
 
     /**
      * Increase or decrease the value of the variable wrapped by the item. If
-     * step==0 add/substract 10^digit, otherwise use the ammount stored in step.
-     * If the value is not at the limits, do the operation and clamp to them,
+     * step==0 add/substract 10^digit, otherwise use the ammount stored in step,
+     * once per step of the direction. If the value is not at the limits, do the operation and clamp to them,
      * returning true. If already at the limits, do nothign and return false.
      */
-    bool changeValue_(uint8_t digit, int8_t direction) override {
+    bool changeValue_(uint8_t digit, int16_t direction) MENU_ITEM_OVERRIDE {
 		T& value = *(T*)data_;
-        if (value == range_.max && direction)
+        if (value == range_.max && direction >= 0)
             return false;
-        if (value == range_.min && !direction)
+        if (value == range_.min && direction < 0)
             return false;
 
-        // TODO: seems to be a bug when editing decimal positions
+        // digit 0 is the last decimal shown
         T step = range_.step;
         if (step == 0)
-            step = fbase10pow<T>(digit);
+            step = fbase10pow<T>((int8_t)digit - (int8_t)precision_);
 
         if (direction >= 0)
-            value += step;
+            value += step * stepCount(direction);
         else
-            value -= step;
+            value -= step * stepCount(direction);
 
         if (value > range_.max)
             value = range_.max;
@@ -515,14 +751,247 @@ public:
         return true;
     }
 
+    /** Digits of the integer part plus the decimals shown */
+    uint8_t getDigitCount_() const MENU_ITEM_OVERRIDE {
+        return decDigits(*(T*)data_) + precision_;
+    }
+
     T getValue() const { return *(T*)data_; }
-    void setValue(T value) { *(T*)data_ = value; }
-	void setValueUnion(ValueUnion* value) override { *(T*)data_ = *(T*)value; }
-	ValueUnion getValueUnion() const override { return *(ValueUnion*)data_; }
+    void setValue(T value) {
+        *(T*)data_ = value;
+        invalidateValueString();
+    }
+	void setValueUnion_(ValueUnion* value) MENU_ITEM_OVERRIDE { memcpy(data_, value, sizeof(T)); }
+	ValueUnion getValueUnion_() const MENU_ITEM_OVERRIDE {
+		ValueUnion value{};
+		memcpy(&value, data_, sizeof(T));
+		return value;
+	}
 };
 
 /** Aliases for convenience */
 typedef DecimalMenuItem<float, MenuItemType::float32> Float32MenuItem;
+#ifdef MENU_WIDE_VALUES
+typedef DecimalMenuItem<double, MenuItemType::float64> Float64MenuItem;
+#endif
+
+//=============================================================================
+// FixedPointMenuItem
+//=============================================================================
+
+/**
+ * Item for decimal values stored as integers scaled by 10^precision, e.g. 12.34
+ * with a precision of 2 is stored as 1234. It is an alternative to
+ * DecimalMenuItem for microcontrollers without FPU, since editing and
+ * formatting use integer arithmetic only.
+ */
+template<typename T, MenuItemType item_type>
+class FixedPointMenuItem : public EndpointMenuItem {
+    static_assert(sizeof(T) <= MAX_MENU_ITEM_VALUE_BYTES,
+            "value type bigger than ValueUnion, see MENU_WIDE_VALUES");
+public:
+    /**
+     * Range specification structure, in scaled units. A step of 0 allows
+     * editing with the cursor.
+     */
+    struct RangeSpec {
+        T min;
+        T max;
+        T step;
+        RangeSpec(T min, T max, T step) : min(min), max(max), step(step) { }
+    };
+private:
+    const RangeSpec range_;
+    /** Number of decimals, i.e. the power of ten of the scale */
+    const uint8_t precision_;
+public:
+
+    FixedPointMenuItem(bool active, const char* info_str, T* value, const RangeSpec& range,
+            uint8_t precision, OnStartEditF& f, OnEndEditF& g, OnChangeF& h, uint16_t value_id)
+        : EndpointMenuItem(item_type, active, info_str, (void*)value, f, g, h, value_id, range.step == 0)
+        , range_(range)
+        , precision_(precision) { }
+
+    FixedPointMenuItem(bool active, const char* info_str, T* value, const RangeSpec& range,
+            uint8_t precision, uint16_t value_id)
+        : FixedPointMenuItem(active, info_str, value, range, precision, onStartEditNOP,
+                onEndEditNOP, onChangeNOP, value_id) {}
+
+    ~FixedPointMenuItem() MENU_ITEM_OVERRIDE { }
+
+    void getValueAsString_(char* buf, size_t sz) const MENU_ITEM_OVERRIDE {
+        itoaFix(buf, sz, *(T*)data_, precision_);
+    }
+
+    /**
+     * Increase or decrease the value by step, or by 10^digit in scaled units if
+     * step is 0, once per step of the direction, clamping to the range. Returns
+     * false if already at the limit.
+     */
+    bool changeValue_(uint8_t digit, int16_t direction) MENU_ITEM_OVERRIDE {
+        T& value = *(T*)data_;
+        if (value == range_.max && direction >= 0)
+            return false;
+        if (value == range_.min && direction < 0)
+            return false;
+
+        T step = range_.step;
+        if (step == 0)
+            step = base10pow(digit);
+
+        // compare before operating so that the value never overflows
+        typedef typename std::make_unsigned<T>::type U;
+        U steps = stepCount(direction);
+        if (direction >= 0)
+            value = (U)(range_.max - (U)value) / (U)step < steps ? range_.max
+                    : (T)((U)value + (U)step * steps);
+        else
+            value = (U)((U)value - range_.min) / (U)step < steps ? range_.min
+                    : (T)((U)value - (U)step * steps);
+
+        return true;
+    }
+
+    /** Digits of the scaled value, at least the decimals plus the units */
+    uint8_t getDigitCount_() const MENU_ITEM_OVERRIDE {
+        uint8_t digits = sciexp(*(T*)data_);
+        return digits > precision_ ? digits : precision_ + 1;
+    }
+
+    T getValue() const { return *(T*)data_; }
+    void setValue(T value) {
+        *(T*)data_ = value;
+        invalidateValueString();
+    }
+    uint8_t getPrecision() const { return precision_; }
+	void setValueUnion_(ValueUnion* value) MENU_ITEM_OVERRIDE { memcpy(data_, value, sizeof(T)); }
+	ValueUnion getValueUnion_() const MENU_ITEM_OVERRIDE {
+		ValueUnion value{};
+		memcpy(&value, data_, sizeof(T));
+		return value;
+	}
+};
+
+/** Aliases for convenience */
+typedef FixedPointMenuItem<int32_t, MenuItemType::fixed32> Fixed32MenuItem;
+
+//=============================================================================
+// EndpointMenuItem dispatch
+//=============================================================================
+
+/*
+ * With MENU_STATIC_DISPATCH the item is down-cast according to its type tag
+ * and the implementation is called directly, which the compiler can inline.
+ */
+#ifdef MENU_WIDE_VALUES
+#define MENU_ITEM_DISPATCH_WIDE(QUAL, CALL) \
+    case MenuItemType::int64: \
+        return static_cast<QUAL Int64MenuItem*>(this)->CALL; \
+    case MenuItemType::float64: \
+        return static_cast<QUAL Float64MenuItem*>(this)->CALL;
+#else
+#define MENU_ITEM_DISPATCH_WIDE(QUAL, CALL)
+#endif
+
+#define MENU_ITEM_DISPATCH(QUAL, CALL) \
+    case MenuItemType::int32: \
+        return static_cast<QUAL Int32MenuItem*>(this)->CALL; \
+    case MenuItemType::uint16: \
+        return static_cast<QUAL Uint16MenuItem*>(this)->CALL; \
+    case MenuItemType::float32: \
+        return static_cast<QUAL Float32MenuItem*>(this)->CALL; \
+    case MenuItemType::fixed32: \
+        return static_cast<QUAL Fixed32MenuItem*>(this)->CALL; \
+    case MenuItemType::sel8u: \
+        return static_cast<QUAL Sel8uMenuItem*>(this)->CALL; \
+    case MenuItemType::sel32u: \
+        return static_cast<QUAL Sel32uMenuItem*>(this)->CALL; \
+    case MenuItemType::boolean: \
+        return static_cast<QUAL BoolMenuItem*>(this)->CALL; \
+    case MenuItemType::uint32: \
+        return static_cast<QUAL Uint32MenuItem*>(this)->CALL; \
+    MENU_ITEM_DISPATCH_WIDE(QUAL, CALL) \
+    default: \
+        break;
+
+inline void EndpointMenuItem::getValueAsString(char *buf, size_t sz) const {
+#ifdef MENU_VALUE_STRING_CACHE
+    // a smaller buffer gets the value truncated as without the cache
+    if (sz < sizeof(value_str_)) {
+        dispatchGetValueAsString(buf, sz);
+        return;
+    }
+    if (value_str_valid_) {
+        valueStringCacheStats().hits++;
+    } else {
+        valueStringCacheStats().misses++;
+        dispatchGetValueAsString(value_str_, sizeof(value_str_));
+        // labels copied with strncpy are not terminated if they fill it
+        value_str_[sizeof(value_str_) - 1] = '\0';
+        value_str_valid_ = true;
+    }
+    // the cached string is terminated and not longer than buf
+    strcpy(buf, value_str_);
+#else
+    dispatchGetValueAsString(buf, sz);
+#endif
+}
+
+inline void EndpointMenuItem::dispatchGetValueAsString(char *buf, size_t sz) const {
+    MENU_STATS_INC(format_calls);
+#ifdef MENU_STATIC_DISPATCH
+    switch (getType()) {
+    MENU_ITEM_DISPATCH(const, getValueAsString_(buf, sz))
+    }
+    buf[0] = '\0';
+#else
+    getValueAsString_(buf, sz);
+#endif
+}
+
+inline void EndpointMenuItem::setValueUnion(ValueUnion* value) {
+    invalidateValueString();
+#ifdef MENU_STATIC_DISPATCH
+    switch (getType()) {
+    MENU_ITEM_DISPATCH(, setValueUnion_(value))
+    }
+#else
+    setValueUnion_(value);
+#endif
+}
+
+inline ValueUnion EndpointMenuItem::getValueUnion() const {
+#ifdef MENU_STATIC_DISPATCH
+    switch (getType()) {
+    MENU_ITEM_DISPATCH(const, getValueUnion_())
+    }
+    return ValueUnion();
+#else
+    return getValueUnion_();
+#endif
+}
+
+inline uint8_t EndpointMenuItem::getDigitCount() const {
+#ifdef MENU_STATIC_DISPATCH
+    switch (getType()) {
+    MENU_ITEM_DISPATCH(const, getDigitCount_())
+    }
+    return 0;
+#else
+    return getDigitCount_();
+#endif
+}
+
+inline bool EndpointMenuItem::dispatchChangeValue(uint8_t digit, int16_t direction) {
+#ifdef MENU_STATIC_DISPATCH
+    switch (getType()) {
+    MENU_ITEM_DISPATCH(, changeValue_(digit, direction))
+    }
+    return false;
+#else
+    return changeValue_(digit, direction);
+#endif
+}
 
 //=============================================================================
 // TempMenuItem
@@ -558,17 +1027,24 @@ public:
         source_ = item_->getValuePointer(); // get original target var
         temp_ = item_->getValueUnion(); // copy current value into temp var
         item_->setValuePointer((void*)&temp_); // swap target variable
+    }
+	/** Value of the variable being edited as it was before the edit */
+    ValueUnion getOriginalValue() const {
+        ValueUnion value{};
+        memcpy(&value, source_, item_->getValueSize());
+        return value;
     }
 	/**
 	 * Revert the swap.
 	 * @param accept set the destination variable with the new value.
+	 * @param notify call the onEndEdit callback of the item when accepting
 	 */
-    void endEdit(bool accept) {
+    void endEdit(bool accept, bool notify = true) {
 		item_->setValuePointer(source_); // swap back to original target
         if (accept) {
-            item_->onEndEdit();
+            if (notify)
+                item_->onEndEdit();
             item_->setValueUnion(&temp_); // set the new value
-			// TODO: send message to store in eeprom
         }
     }
 };
@@ -2,13 +2,18 @@
  * File:   menu_section.h
  * Author: German Gambon
  *
- * Created on 22 de abril de 2016, 21:10 */
+ * Created on 22 de abril de 2016, 21:10
+ */
 
 #ifndef MENU_SECTION_H
 #define MENU_SECTION_H
 
+#include <cstddef>
+#include <new>
+#include <utility>
 #include "menu_item.h"
 #include "functors.h"
+#include "menu_stats.h"
 
 typedef unsigned int uint;
 
@@ -20,8 +25,8 @@ typedef void NoOnExit;
 //=============================================================================
 
 /**
- * Empty, virtual base class as interface for correct destruction of any
- * derived context used for a given section. Used as dummy section ctx too.
+ * Empty, virtual base class that can be used as interface for any derived
+ * context used for a given section. Used as dummy section ctx too.
  */
 struct SecCtx {
     virtual ~SecCtx();
@@ -29,23 +34,68 @@ struct SecCtx {
 inline SecCtx::~SecCtx() { }
 
 /**
- * Structure to encapsulate the data required to run onExit functors after their
- * section has been destroyed.
- *
- * The class constructor expects heap-allocated objects and they are guaranteed to be
- * deleted by the destructor.
+ * Number of bytes reserved per menu level for keeping the context and onExit
+ * functor of a section after the section has been destroyed. The default fits a
+ * functor (vtable and context reference) plus a couple of pointer-sized
+ * context fields.
+ */
+#ifndef MAX_SEC_ONEXIT_CTX_BYTES
+#define MAX_SEC_ONEXIT_CTX_BYTES (4 * sizeof(void*))
+#endif
+
+/**
+ * Inline storage for the data required to run onExit functors after their
+ * section has been destroyed. The section constructs a copy of its context and
+ * functor in place, so no dynamic allocation is involved, and the concrete
+ * type is erased behind a couple of function pointers.
  */
-struct SecOnExitCtx {
-    SecCtx *ctx;
-    OnExitF *onExitF;
-    uint section;
-    SecOnExitCtx(SecCtx* ctx, OnExitF* onExitF, uint section)
-        : ctx(ctx), onExitF(onExitF), section(section) { }
-    ~SecOnExitCtx() {
-        delete onExitF;
-        delete ctx;
+class SecOnExitCtx {
+    alignas(std::max_align_t) unsigned char mem_[MAX_SEC_ONEXIT_CTX_BYTES];
+    void (*onExit_)(void*){NULL};
+    void (*destroy_)(void*){NULL};
+    uint section_{0};
+
+    template<typename T>
+    static void callOnExit(void* p) { (*(T*)p)(); }
+    template<typename T>
+    static void destroy(void* p) { ((T*)p)->~T(); }
+public:
+    SecOnExitCtx() { }
+    SecOnExitCtx(const SecOnExitCtx&) = delete;
+    SecOnExitCtx& operator=(const SecOnExitCtx&) = delete;
+    ~SecOnExitCtx() { clear(); }
+    /**
+     * Construct in place an object of type T, callable with no arguments,
+     * destroying the one previously held.
+     */
+    template<typename T, typename... ARGS>
+    void emplace(uint section, ARGS&&... args) {
+        static_assert(sizeof(T) <= MAX_SEC_ONEXIT_CTX_BYTES,
+                "onExit context too big, increase MAX_SEC_ONEXIT_CTX_BYTES");
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                "onExit context alignment not supported");
+        clear();
+        new (mem_) T(std::forward<ARGS>(args)...);
+        onExit_ = &callOnExit<T>;
+        destroy_ = &destroy<T>;
+        section_ = section;
+        MENU_STATS_INC(onexit_ctxs_saved);
+    }
+    /** Destroy the object held, if any, without running it. */
+    void clear() {
+        if (destroy_)
+            destroy_(mem_);
+        onExit_ = NULL;
+        destroy_ = NULL;
+    }
+    bool isEmpty() const { return onExit_ == NULL; }
+    uint getSection() const { return section_; }
+    void onExit() {
+        if (onExit_) {
+            MENU_STATS_INC(callback_calls);
+            onExit_(mem_);
+        }
     }
-	void onExit() { (*onExitF)(); }
 };
 
 //=============================================================================
@@ -69,10 +119,10 @@ public:
     /** Return the type of the section. */
     uint getId() { return section_; }
     /**
-     * Returns the context required for running onExit callbacks so that they
+     * Store into ctx what is required for running onExit callbacks so that they
      * can be executed after the section has been destroyed.
      */
-    virtual SecOnExitCtx* getOnExitContext() { return NULL; }
+    virtual void saveOnExitContext(SecOnExitCtx& ctx) { ctx.clear(); }
     virtual void onEnter() { }
     virtual void onExit() { }
 protected:
@@ -101,6 +151,9 @@ inline BaseMenuSection::~BaseMenuSection() { }
  */
 template<typename CTX, typename ONEXIT, size_t SZ, uint SEC>
 class SectionTemplate : public BaseMenuSection {
+public:
+    /** Section ID, known at compile time for StaticMenu */
+    static const uint id = SEC;
 protected:
     static const uint8_t size_{SZ};
     CTX ctx_;
@@ -111,6 +164,14 @@ protected:
     } items_;
     // section's onExit callback
     ONEXIT onExit_{ctx_};
+    // copy of the context together with a functor bound to it, which outlives
+    // the section in the MenuController
+    struct OnExitState {
+        CTX ctx;
+        ONEXIT onExit{ctx};
+        OnExitState(const CTX& ctx) : ctx(ctx) { }
+        void operator()() { onExit(); }
+    };
 public:
     SectionTemplate(const CTX& ctx, const Items& items)
         : BaseMenuSection(SEC), ctx_(ctx), items_(items) { }
@@ -119,8 +180,8 @@ public:
 
     uint8_t getSize() override { return size_; }
     AbstractMenuItem** getItems() override { return items_.items; }
-    SecOnExitCtx* getOnExitContext() override {
-        return new SecOnExitCtx{new CTX(ctx_), new ONEXIT(onExit_), SEC};
+    void saveOnExitContext(SecOnExitCtx& ctx) override {
+        ctx.emplace<OnExitState>(SEC, ctx_);
     }
 };
 
@@ -129,6 +190,8 @@ public:
  */
 template<typename CTX, size_t SZ, uint SEC>
 class SectionTemplate<CTX, void, SZ, SEC> : public BaseMenuSection {
+public:
+    static const uint id = SEC;
 protected:
     CTX ctx_;
     static const uint8_t size_{SZ};
@@ -149,6 +212,8 @@ public:
  */
 template<size_t SZ, uint SEC>
 class SectionTemplate<void, void, SZ, SEC> : public BaseMenuSection {
+public:
+    static const uint id = SEC;
 protected:
     static const uint8_t size_{SZ};
     struct Items {
@@ -168,6 +233,8 @@ public:
  */
 template<typename ONEXIT, size_t SZ, uint SEC>
 class SectionTemplate<void, ONEXIT, SZ, SEC> : public BaseMenuSection {
+public:
+    static const uint id = SEC;
 protected:
     static const uint8_t size_{SZ};
     struct Items {
@@ -182,8 +249,8 @@ public:
 
     uint8_t getSize() override { return size_; }
     AbstractMenuItem** getItems() override { return items_.items; }
-    SecOnExitCtx* getOnExitContext() override {
-        return new SecOnExitCtx{NULL, new ONEXIT(onExit_), SEC};
+    void saveOnExitContext(SecOnExitCtx& ctx) override {
+        ctx.emplace<ONEXIT>(SEC, onExit_);
     }
 };
 
@@ -0,0 +1,71 @@
+/*
+ * File:   menu_stats.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:29
+ */
+
+#ifndef MENU_STATS_H
+#define MENU_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+//=============================================================================
+// MenuStats
+//=============================================================================
+
+/**
+ * Counters of what a menu session costs, enabled by defining MENU_STATS. When
+ * it is not defined the counting macros expand to nothing, so there is no
+ * overhead at all.
+ *
+ * Counters are global, shared by all the menus and controllers, since the
+ * places where they are updated (arenas, items, onExit contexts) do not know
+ * which controller they belong to.
+ */
+struct MenuStats {
+    uint32_t sections_created;
+    uint32_t sections_destroyed;
+    uint32_t onexit_ctxs_saved; // onExit contexts kept after leaving a section
+    size_t bytes_live; // bytes taken by the sections alive
+    size_t bytes_peak; // max of bytes_live
+    uint32_t format_calls; // item values converted to string
+    uint32_t callback_calls; // item functors and saved onExit contexts run
+};
+
+#ifdef MENU_STATS
+
+/** Global instance, shared by all translation units */
+inline MenuStats& menuStats() {
+    static MenuStats stats{};
+    return stats;
+}
+
+inline void menuStatsSectionCreated(size_t bytes) {
+    MenuStats& stats = menuStats();
+    stats.sections_created++;
+    stats.bytes_live += bytes;
+    if (stats.bytes_live > stats.bytes_peak)
+        stats.bytes_peak = stats.bytes_live;
+}
+
+inline void menuStatsSectionDestroyed(size_t bytes) {
+    MenuStats& stats = menuStats();
+    stats.sections_destroyed++;
+    stats.bytes_live -= bytes;
+}
+
+#define MENU_STATS_INC(counter) (menuStats().counter++)
+#define MENU_STATS_SECTION_CREATED(bytes) menuStatsSectionCreated(bytes)
+#define MENU_STATS_SECTION_DESTROYED(bytes) menuStatsSectionDestroyed(bytes)
+
+#else
+
+#define MENU_STATS_INC(counter) ((void)0)
+#define MENU_STATS_SECTION_CREATED(bytes) ((void)0)
+#define MENU_STATS_SECTION_DESTROYED(bytes) ((void)0)
+
+#endif /* MENU_STATS */
+
+#endif /* MENU_STATS_H */
@@ -0,0 +1,721 @@
+/*
+ * File:   menu_test.cpp
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 01:05
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include "menu_controller.h"
+#include "menu_events.h"
+#include "menu_history.h"
+#include "static_menu.h"
+#include "synthetic_menu.h"
+#include "value_registry.h"
+#include "value_store.h"
+
+using namespace std;
+
+/**
+ * EEPROM of SIZE bytes in RAM, which can lose power in the middle of a write:
+ * the write number power_fail only gets half of its bytes written, and the
+ * following ones none.
+ */
+template<size_t SIZE>
+class RamEeprom : public EepromDevice {
+public:
+    uint8_t mem[SIZE];
+    uint32_t writes{0};
+    uint32_t power_fail{0}; // 0 for never
+    RamEeprom() { memset(mem, 0xFF, SIZE); }
+    size_t getSize() const override { return SIZE; }
+    void read(size_t addr, void* buf, size_t sz) override { memcpy(buf, mem + addr, sz); }
+    void write(size_t addr, const void* buf, size_t sz) override {
+        writes++;
+        if (power_fail != 0 && writes > power_fail)
+            return;
+        memcpy(mem + addr, buf, writes == power_fail ? sz / 2 : sz);
+    }
+};
+
+/** Three levels, two children per section and an int and a float per section */
+typedef SyntheticMenu<3, 2, 2, SYNTHETIC_INT32 | SYNTHETIC_FLOAT32> SmallMenu;
+/** A single section with 8 ints from -100000 to 100000, edited digit-wise */
+typedef SyntheticMenu<1, 0, 8, SYNTHETIC_INT32> FlatMenu;
+
+void test_syntheticMenu() {
+    SmallMenu menu;
+
+    cout << "SyntheticMenu:" << endl;
+
+    assert(SmallMenu::section_count == 7 && SmallMenu::value_count == 14);
+    assert(menu.createSection(SmallMenu::section_count) == NULL);
+
+    // the links come first, then the values
+    BaseMenuSection* root = menu.createRoot();
+    assert(root->getSize() == 4);
+    AbstractMenuItem** items = root->getItems();
+    assert(items[0]->isSection() && ((SectionMenuItem*)items[0])->getSectionId() == 1);
+    assert(items[1]->isSection() && ((SectionMenuItem*)items[1])->getSectionId() == 2);
+    assert(items[2]->getType() == MenuItemType::int32);
+    assert(items[3]->getType() == MenuItemType::float32);
+    // a single slot, which must be free again once destroyed
+    assert(menu.createSection(1) == NULL);
+    menu.destroySection(root);
+
+    // root > section 1 > section 4, a leaf whose first value has ID 8
+    MenuController ctrl(menu);
+    ctrl.enter();
+    ctrl.down();
+    ctrl.enter();
+    assert(ctrl.getPath().level == 2 && ctrl.getPath().section_id[2] == 4);
+    assert(ctrl.getCurrentItem()->getType() == MenuItemType::int32);
+    ctrl.enter();
+    ctrl.up();
+    ctrl.enter();
+    assert(menu.getValue(8).integer == 1);
+
+    // going back and forth reuses the slot every time
+    for (int i = 0; i < 100; i++) {
+        ctrl.escape();
+        ctrl.enter();
+    }
+    assert(ctrl.getPath().section_id[2] == 4);
+    ctrl.escape();
+    ctrl.escape();
+    assert(ctrl.getPath().level == 0);
+    ctrl.escape();
+    assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::MENU_AT_ROOT);
+
+    cout << "OK" << endl << endl;
+}
+
+void test_visibleRows() {
+    SmallMenu menu;
+
+    cout << "Visible rows:" << endl;
+
+    // no rows at all is taken as one, rather than never ending a page
+    {
+        MenuController ctrl(menu, NULL, 0);
+        assert(ctrl.getVisibleRows() == 1 && ctrl.getNavCtrl().getPages() == 4);
+        ctrl.setVisibleRows(3);
+        assert(ctrl.getNavCtrl().getPages() == 2);
+        ctrl.setVisibleRows(0);
+        assert(ctrl.getVisibleRows() == 1);
+        ctrl.end();
+        assert(ctrl.getCurrentIndex() == 3 && ctrl.getNavCtrl().getFirst() == 3);
+    }
+    {
+        ScrollMenuController ctrl(menu, NULL, 0);
+        assert(ctrl.getVisibleRows() == 1);
+        ctrl.setVisibleRows(0);
+        assert(ctrl.getVisibleRows() == 1);
+        ctrl.end();
+        assert(ctrl.getNavCtrl().getFirst() == 3);
+    }
+
+    cout << "OK" << endl << endl;
+}
+
+/** Counts the onChange calls of the items */
+class CountChange : public OnChangeF {
+public:
+    int calls{0};
+    void operator()(EndpointMenuItem& item) override { calls++; }
+};
+
+static CountChange step_change;
+static int32_t step_int{0};
+static uint8_t step_sel{0};
+static const char* const step_labels[] {"A", "B", "C"};
+static const uint8_t step_values[] {0, 1, 2};
+
+/** Items edited in fixed steps, counting their changes */
+class StepRoot : public SectionTemplate<NoCtx, NoOnExit, 2, 0> {
+    Int32MenuItem integer{true, "Int", &step_int, {-10, 10, 3}, onStartEditNOP,
+            onEndEditNOP, step_change, 0};
+    Sel8uMenuItem sel{true, "Sel", &step_sel, step_labels, step_values, 3,
+            onStartEditNOP, onEndEditNOP, step_change, 1};
+public:
+    StepRoot() : SectionTemplate({&integer, &sel}) { }
+};
+
+typedef StaticMenu<1, StepRoot> StepMenu;
+
+void test_eventQueue() {
+    FlatMenu menu;
+    MenuEventQueue<16> queue;
+
+    cout << "MenuEventQueue:" << endl;
+
+    // repeated keys in edit mode change the value by as many steps
+    {
+        MenuController ctrl(menu);
+        ctrl.enter();
+        for (int i = 0; i < 5; i++)
+            queue.push(MenuAction::UP);
+        ctrl.processEvents(queue);
+        assert(queue.isEmpty());
+        assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::EDIT_VALUE_UP);
+        ctrl.enter();
+        assert(menu.getValue(0).integer == 5);
+        // and stop at the limit
+        menu.getValue(0).integer = 99998;
+        ctrl.enter();
+        for (int i = 0; i < 5; i++)
+            queue.push(MenuAction::UP);
+        ctrl.processEvents(queue);
+        assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::EDIT_VALUE_UP);
+        for (int i = 0; i < 5; i++)
+            queue.push(MenuAction::UP);
+        ctrl.processEvents(queue);
+        assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::EDIT_TOP_REACHED);
+        ctrl.enter();
+        assert(menu.getValue(0).integer == 100000);
+    }
+    // as a single change of as many steps
+    {
+        StepMenu step_menu;
+        MenuController ctrl(step_menu);
+        ctrl.enter();
+        for (int i = 0; i < 5; i++)
+            queue.push(MenuAction::UP);
+        ctrl.processEvents(queue);
+        assert(step_change.calls == 1);
+        assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::EDIT_VALUE_UP);
+        ctrl.enter();
+        assert(step_int == 10);
+        ctrl.enter();
+        for (int i = 0; i < 3; i++)
+            queue.push(MenuAction::DOWN);
+        ctrl.processEvents(queue);
+        ctrl.enter();
+        assert(step_int == 1 && step_change.calls == 2);
+        // selections wrap around
+        ctrl.down();
+        ctrl.enter();
+        for (int i = 0; i < 4; i++)
+            queue.push(MenuAction::UP);
+        ctrl.processEvents(queue);
+        ctrl.enter();
+        assert(step_sel == 1 && step_change.calls == 3);
+        ctrl.enter();
+        for (int i = 0; i < 5; i++)
+            queue.push(MenuAction::DOWN);
+        ctrl.processEvents(queue);
+        ctrl.enter();
+        assert(step_sel == 2 && step_change.calls == 4);
+    }
+    // two shifts of the window in a batch redraw the whole page
+    {
+        ScrollMenuController ctrl(menu, NULL, 2);
+        queue.push(MenuAction::DOWN);
+        ctrl.processEvents(queue);
+        assert(!(ctrl.getStateInfo().getDirtyFlags() & StateInfo::DIRTY_SCROLL));
+        queue.push(MenuAction::DOWN);
+        ctrl.processEvents(queue);
+        uint8_t flags = ctrl.getStateInfo().getDirtyFlags();
+        assert((flags & StateInfo::DIRTY_SCROLL) && !(flags & StateInfo::DIRTY_PAGE));
+        assert(ctrl.getStateInfo().getScroll() == 1);
+        // undo breaks the run of downs, and fails as there is no history
+        queue.push(MenuAction::DOWN);
+        queue.push(MenuAction::UNDO);
+        queue.push(MenuAction::DOWN);
+        ctrl.processEvents(queue);
+        assert(ctrl.getCurrentIndex() == 4);
+        assert(ctrl.getStateInfo().getDirtyFlags() & StateInfo::DIRTY_PAGE);
+    }
+
+    cout << "OK" << endl << endl;
+}
+
+//========== Menu with a value registry ===========
+
+static int32_t reg_int{10};
+static float reg_float{2.5};
+static bool reg_bool{false};
+
+class RegRoot : public SectionTemplate<NoCtx, NoOnExit, 3, 0> {
+    Int32MenuItem integer{true, "Int", &reg_int, {0, 100, 1}, 0};
+    BoolMenuItem boolean{true, "Bool", &reg_bool, 2};
+    SectionMenuItem child{1, true, "Child"};
+public:
+    RegRoot() : SectionTemplate({&integer, &boolean, &child}) { }
+};
+
+class RegChild : public SectionTemplate<NoCtx, NoOnExit, 2, 1> {
+    Float32MenuItem real{true, "Float", &reg_float, {0, 10, 0}, 2, 1};
+    BoolMenuItem boolean{true, "Bool", &reg_bool, 2};
+public:
+    RegChild() : SectionTemplate({&real, &boolean}) { }
+};
+
+typedef StaticMenu<1, RegRoot, RegChild> RegMenu;
+/** With a slot more for a SectionCache */
+typedef StaticMenu<2, RegRoot, RegChild> CachedRegMenu;
+
+static const ValueEntry reg_values[] {
+    {&reg_int, 0, MenuItemType::int32},
+    {&reg_float, 1, MenuItemType::float32},
+    {&reg_bool, 2, MenuItemType::boolean},
+};
+static const ValueRegistry reg_registry(reg_values);
+
+/** Put the values 0 to 3 with base + ID and flush them */
+void putValues(ValueStore& store, int32_t base) {
+    for (uint16_t id = 0; id < 4; id++) {
+        int32_t value = base + id;
+        store.put(id, &value, sizeof(value));
+    }
+    store.flush();
+}
+
+void test_valueStore() {
+    int32_t value;
+
+    cout << "ValueStore:" << endl;
+
+    // too small for the journal, nothing is stored rather than hanging
+    {
+        RamEeprom<64> eeprom;
+        ValueStore store(eeprom);
+        store.begin();
+        assert(!store.hasRoom());
+        value = 1;
+        assert(!store.put(0, &value, sizeof(value)));
+        store.flush();
+        assert(eeprom.writes == 0);
+    }
+
+    RamEeprom<1024> eeprom;
+    {
+        ValueStore store(eeprom);
+        store.begin();
+        assert(store.hasRoom());
+        putValues(store, 100);
+        // the journal wraps many times while 1 to 3 stay where they are
+        for (int32_t i = 0; i < 500; i++) {
+            store.put(0, &i, sizeof(i));
+            store.flush();
+        }
+        // unchanged values are not written again
+        uint32_t written = store.getRecordsWritten();
+        putValues(store, 100);
+        assert(store.getRecordsWritten() == written + 1);
+    }
+    // found again on startup
+    {
+        ValueStore store(eeprom);
+        store.begin();
+        for (uint16_t id = 0; id < 4; id++) {
+            assert(store.get(id, &value, sizeof(value)));
+            assert(value == 100 + id);
+        }
+        assert(!store.get(4, &value, sizeof(value)));
+    }
+    // a power loss at any write loses at most the value being written, which
+    // keeps the previous one
+    for (uint32_t fail = 1; fail <= 8; fail++) {
+        RamEeprom<1024> copy = eeprom;
+        copy.writes = 0;
+        copy.power_fail = fail;
+        {
+            ValueStore store(copy);
+            store.begin();
+            putValues(store, 200);
+            putValues(store, 300);
+        }
+        copy.power_fail = 0;
+        ValueStore store(copy);
+        store.begin();
+        // value ID is written by the write number ID + 1 in the first round,
+        // and ID + 5 in the second one
+        for (uint16_t id = 0; id < 4; id++) {
+            assert(store.get(id, &value, sizeof(value)));
+            assert(value == (fail > id + 5u ? 300 : fail > id + 1u ? 200 : 100) + id);
+        }
+    }
+
+    // flush policies
+    {
+        RamEeprom<1024> eeprom;
+        ValueStore store(eeprom);
+        store.begin();
+        store.setFlushThreshold(2);
+        value = 1;
+        store.put(0, &value, sizeof(value));
+        store.put(0, &value, sizeof(value));
+        assert(store.getPendingCount() == 1);
+        store.put(1, &value, sizeof(value));
+        assert(store.getPendingCount() == 0 && eeprom.writes == 2);
+        store.setFlushThreshold(VALUE_STORE_PENDING);
+        store.setFlushDelay(10);
+        store.put(2, &value, sizeof(value));
+        store.poll(100);
+        store.poll(109);
+        assert(store.getPendingCount() == 1);
+        store.poll(110);
+        assert(store.getPendingCount() == 0 && eeprom.writes == 3);
+    }
+    // the controller flushes when leaving a section, either way
+    {
+        RamEeprom<1024> eeprom;
+        ValueStore store(eeprom);
+        store.begin();
+        RegMenu menu;
+        MenuController ctrl(menu);
+        ctrl.setValueStore(&store);
+        ctrl.enter();
+        ctrl.up();
+        ctrl.enter();
+        assert(store.getPendingCount() == 1);
+        ctrl.end();
+        ctrl.enter();
+        assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::MENU_LEVEL_DOWN);
+        assert(store.getPendingCount() == 0 && eeprom.writes == 1);
+        ctrl.enter();
+        ctrl.up();
+        ctrl.enter();
+        assert(store.getPendingCount() == 1);
+        ctrl.escape();
+        assert(store.getPendingCount() == 0 && eeprom.writes == 2);
+        reg_int = 10;
+        reg_float = 2.5;
+    }
+
+    cout << "OK" << endl << endl;
+}
+
+void test_valueRegistry() {
+    RegMenu menu;
+
+    cout << "ValueRegistry:" << endl;
+
+    assert(menu.checkLinks());
+    assert(reg_registry.check(menu, RegMenu::section_count));
+    // wrong type, variable or value ID
+    static const ValueEntry wrong_type[] {{&reg_float, 1, MenuItemType::int32}};
+    static const ValueEntry wrong_address[] {{&reg_int, 1, MenuItemType::float32}};
+    static const ValueEntry wrong_id[] {{&reg_bool, 3, MenuItemType::boolean}};
+    assert(!ValueRegistry(wrong_type).check(menu, RegMenu::section_count));
+    assert(!ValueRegistry(wrong_address).check(menu, RegMenu::section_count));
+    assert(!ValueRegistry(wrong_id).check(menu, RegMenu::section_count));
+    // missing sections
+    assert(!reg_registry.check(menu, RegMenu::section_count + 1));
+
+    // snapshots
+    uint8_t buf[32];
+    size_t size = reg_registry.snapshot(buf, sizeof(buf));
+    assert(size == reg_registry.getSnapshotSize() && size == 2 + 4 + 4 + 1);
+    assert(reg_registry.snapshot(buf, size - 1) == 0);
+    reg_int = 50;
+    reg_bool = true;
+    assert(reg_registry.restoreSnapshot(buf, size));
+    assert(reg_int == 10 && !reg_bool);
+    // rejected if the size or the layout differ, without changing anything
+    reg_int = 50;
+    assert(!reg_registry.restoreSnapshot(buf, size - 1));
+    static const ValueEntry reordered[] {
+        {&reg_float, 1, MenuItemType::float32},
+        {&reg_int, 0, MenuItemType::int32},
+        {&reg_bool, 2, MenuItemType::boolean},
+    };
+    ValueRegistry other(reordered);
+    assert(other.getSnapshotSize() == size);
+    assert(!other.restoreSnapshot(buf, size));
+    buf[0] ^= 1;
+    assert(!reg_registry.restoreSnapshot(buf, size));
+    assert(reg_int == 50);
+    reg_int = 10;
+
+    // bulk save and restore through a store
+    RamEeprom<1024> eeprom;
+    {
+        ValueStore store(eeprom);
+        store.begin();
+        reg_registry.save(store);
+        store.flush();
+    }
+    reg_int = 0;
+    reg_float = 0;
+    ValueStore store(eeprom);
+    store.begin();
+    assert(reg_registry.restore(store) == 3);
+    assert(reg_int == 10 && reg_float == 2.5);
+
+    cout << "OK" << endl << endl;
+}
+
+/** Commit callback rejecting the values until told otherwise */
+class RejectCommit : public OnCommitF {
+public:
+    bool accept{false};
+    int committed{0};
+    bool validate(const MenuTransaction& transaction) override { return accept; }
+    void operator()(const MenuTransaction& transaction) override { committed++; }
+};
+
+#ifdef MENU_TRACE
+/** The last action traced */
+template<class CTRL>
+MenuAction lastAction(const CTRL& ctrl) {
+    return ctrl.getTrace().get(ctrl.getTrace().getCount() - 1).action;
+}
+#endif
+
+void test_transaction() {
+    RegMenu menu;
+    MenuController ctrl(menu);
+    MenuEventQueue<8> queue;
+    RejectCommit on_commit;
+
+    cout << "Transactions:" << endl;
+
+    reg_int = 10;
+    // nothing to commit or roll back
+    ctrl.commit();
+    assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::TRANSACTION_FAILED);
+    ctrl.rollback();
+    assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::TRANSACTION_FAILED);
+#ifdef MENU_TRACE
+    assert(lastAction(ctrl) == MenuAction::ROLLBACK);
+#endif
+
+    // accepted edits are only set on commit, once validated
+    ctrl.beginTransaction(&on_commit);
+    assert(ctrl.isInTransaction());
+    ctrl.enter();
+    ctrl.up();
+    ctrl.enter();
+    assert(reg_int == 10);
+    ctrl.commit();
+    assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::TRANSACTION_FAILED);
+    assert(ctrl.isInTransaction() && reg_int == 10 && on_commit.committed == 0);
+    on_commit.accept = true;
+    // the edit in progress is accepted too
+    ctrl.enter();
+    ctrl.up();
+    ctrl.commit();
+    assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::TRANSACTION_COMMIT);
+    assert(!ctrl.isInTransaction() && reg_int == 12 && on_commit.committed == 1);
+    assert(ctrl.getStateInfo().getState() == StateInfo::Mode::NAVIGATE);
+#ifdef MENU_TRACE
+    assert(lastAction(ctrl) == MenuAction::COMMIT);
+#endif
+
+    // rolled back from the queue, a repeated begin failing
+    queue.push(MenuAction::BEGIN);
+    queue.push(MenuAction::BEGIN);
+    queue.push(MenuAction::ENTER);
+    queue.push(MenuAction::UP);
+    queue.push(MenuAction::ENTER);
+    ctrl.processEvents(queue);
+    assert(ctrl.isInTransaction() && reg_int == 12);
+    queue.push(MenuAction::ROLLBACK);
+    ctrl.processEvents(queue);
+    assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::TRANSACTION_ROLLBACK);
+    assert(!ctrl.isInTransaction() && reg_int == 12);
+    // and also by leaving the section
+    ctrl.beginTransaction();
+    ctrl.enter();
+    ctrl.up();
+    ctrl.enter();
+    ctrl.end();
+    ctrl.enter();
+    assert(!ctrl.isInTransaction() && reg_int == 12);
+    ctrl.escape();
+    reg_int = 10;
+
+    cout << "OK" << endl << endl;
+}
+
+/** History entry of the value ID, linked or not to the previous one */
+MenuHistoryEntry historyEntry(uint16_t id, bool linked) {
+    MenuHistoryEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.value_id = id;
+    entry.size = 1;
+    entry.linked = linked;
+    return entry;
+}
+
+/** Counts the values undone and redone */
+class CountUndo : public OnUndoF {
+public:
+    int undone{0};
+    int redone{0};
+    void operator()(const MenuHistoryEntry& entry, bool undo) override {
+        (undo ? undone : redone)++;
+    }
+};
+
+void test_history() {
+    cout << "MenuHistory:" << endl;
+
+    MenuHistory<4> history;
+    assert(!history.canUndo() && !history.canRedo());
+    // a single change and a group of 3
+    history.record(historyEntry(1, false));
+    history.record(historyEntry(2, false));
+    history.record(historyEntry(3, true));
+    history.record(historyEntry(4, true));
+    assert(history.getUndoCount() == 3 && history.getUndo(0).value_id == 4);
+    // the oldest one is evicted
+    history.record(historyEntry(5, false));
+    history.undone(history.getUndoCount());
+    assert(history.getUndoCount() == 3 && history.getUndo(2).value_id == 2);
+    history.undone(history.getUndoCount());
+    assert(!history.canUndo() && history.getRedoCount() == 3);
+    history.redone(3);
+    history.redone(1);
+    // evicting the first change of the group evicts the rest of it, which
+    // could not be undone on its own
+    history.record(historyEntry(6, false));
+    assert(history.getUndoCount() == 1 && history.getUndo(0).value_id == 6);
+    history.undone(1);
+    assert(history.getUndoCount() == 1 && history.getUndo(0).value_id == 5);
+    history.undone(1);
+    assert(!history.canUndo());
+    // recording discards what could be redone
+    history.record(historyEntry(7, false));
+    assert(!history.canRedo() && history.getUndoCount() == 1);
+    // a group bigger than the ring keeps its last entries only
+    history.record(historyEntry(8, false));
+    for (uint16_t id = 9; id < 14; id++)
+        history.record(historyEntry(id, true));
+    uint8_t n = history.getUndoCount();
+    assert(n > 0 && n <= 4 && history.getUndo(0).value_id == 13);
+    history.undone(n);
+    assert(!history.canUndo());
+
+    // undoing from another section through the registry
+    CachedRegMenu menu;
+    SectionCache cache(menu.getSectionBytes());
+    MenuController ctrl(menu, &cache);
+    CountUndo on_undo;
+    ctrl.setValueRegistry(&reg_registry);
+    ctrl.setOnUndo(&on_undo);
+    char buf[16];
+    reg_int = 10;
+    ctrl.enter();
+    ctrl.up();
+    ctrl.enter();
+    assert(reg_int == 11);
+    ctrl.end();
+    ctrl.enter();
+    assert(cache.getCount() == 1);
+    ctrl.undo();
+    assert(ctrl.getStateInfo().getActionResult() == StateInfo::ActionResult::HISTORY_UNDO);
+    assert(reg_int == 10 && on_undo.undone == 1);
+    ctrl.escape();
+    ctrl.home();
+    ((const EndpointMenuItem*)ctrl.getCurrentItem())->getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, "10") == 0);
+    ctrl.redo();
+    assert(reg_int == 11 && on_undo.redone == 1);
+    ((const EndpointMenuItem*)ctrl.getCurrentItem())->getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, "11") == 0);
+    reg_int = 10;
+
+    cout << "OK" << endl << endl;
+}
+
+void test_valueString() {
+    const char* const labels[] = {"Short", "A label longer than the cache"};
+    const uint8_t values[] = {0, 1};
+    uint8_t sel = 1;
+    Sel8uMenuItem item(true, "sel", &sel, labels, values, 2, 0);
+    char buf[40];
+
+    cout << "value string:" << endl << endl;
+
+    // long labels are cut to the cache, but always terminated
+    memset(buf, 'x', sizeof(buf));
+    item.getValueAsString(buf, sizeof(buf));
+    assert(strlen(buf) < sizeof(buf) && strncmp(buf, labels[1], strlen(buf)) == 0);
+    item.getValueAsString(buf, sizeof(buf));
+    assert(strlen(buf) < sizeof(buf) && strncmp(buf, labels[1], strlen(buf)) == 0);
+    item.changeValue(0, -1);
+    item.getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, "Short") == 0);
+
+    cout << "OK" << endl << endl;
+}
+
+void test_valueLimits() {
+    char buf[24];
+
+    cout << "value limits:" << endl << endl;
+
+    // steps bigger than the distance to the limit clamp instead of wrapping
+    uint32_t u32 = 5;
+    Uint32MenuItem u32_item(true, "u32", &u32, Uint32MenuItem::RangeSpec(0, UINT32_MAX, 100), 0);
+    assert(u32_item.changeValue(0, -1) && u32 == 0);
+    assert(!u32_item.changeValue(0, -1) && u32 == 0);
+    u32 = UINT32_MAX - 5;
+    assert(u32_item.changeValue(0, 1) && u32 == UINT32_MAX);
+    assert(!u32_item.changeValue(0, 1));
+
+    int32_t i32 = INT32_MAX - 1;
+    Int32MenuItem i32_item(true, "i32", &i32, Int32MenuItem::RangeSpec(INT32_MIN, INT32_MAX, 0), 0);
+    assert(i32_item.changeValue(9, 1) && i32 == INT32_MAX);
+    i32 = INT32_MIN + 1;
+    assert(i32_item.changeValue(9, -1) && i32 == INT32_MIN);
+    assert(i32_item.changeValue(0, 1) && i32 == INT32_MIN + 1);
+
+    int32_t fixed = 0;
+    Fixed32MenuItem fixed_item(true, "fix", &fixed, Fixed32MenuItem::RangeSpec(INT32_MIN, INT32_MAX, 0), 2, 0);
+    fixed = INT32_MAX - 10;
+    assert(fixed_item.changeValue(9, 1) && fixed == INT32_MAX);
+    fixed = INT32_MIN + 10;
+    assert(fixed_item.changeValue(9, -1) && fixed == INT32_MIN);
+
+    // float parts that do not fit in 32 bits are off limits, not garbage
+    float f32 = 5e9f;
+    Float32MenuItem f32_item(true, "f32", &f32, Float32MenuItem::RangeSpec(-1e10f, 1e10f, 0), 2, 0);
+    f32_item.getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, off_limits) == 0);
+    assert(f32_item.getDigitCount() == 12);
+#ifdef MENU_WIDE_VALUES
+    int64_t i64 = INT64_MAX - 1;
+    Int64MenuItem i64_item(true, "i64", &i64, Int64MenuItem::RangeSpec(INT64_MIN, INT64_MAX, 0), 0);
+    assert(i64_item.changeValue(18, 1) && i64 == INT64_MAX);
+    i64 = INT64_MIN + 1;
+    assert(i64_item.changeValue(18, -1) && i64 == INT64_MIN);
+
+    double f64 = 5e9;
+    Float64MenuItem f64_item(true, "f64", &f64, Float64MenuItem::RangeSpec(-1e17, 1e17, 0), 2, 0);
+    f64_item.getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, "5000000000.00") == 0);
+    assert(f64_item.getDigitCount() == 12);
+    f64 = -0.5;
+    f64_item.setValue(f64);
+    f64_item.getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, "-0.50") == 0);
+    f64_item.setValue(-123456789012345.25);
+    f64_item.getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, "-123456789012345.25") == 0);
+    f64_item.setValue(1e19);
+    f64_item.getValueAsString(buf, sizeof(buf));
+    assert(strcmp(buf, off_limits) == 0);
+#endif
+
+    cout << "OK" << endl << endl;
+}
+
+int main(int argc, char** argv) {
+    test_syntheticMenu();
+    test_visibleRows();
+    test_eventQueue();
+    test_valueStore();
+    test_valueRegistry();
+    test_transaction();
+    test_history();
+    test_valueString();
+    test_valueLimits();
+    return 0;
+}
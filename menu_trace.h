@@ -0,0 +1,97 @@
+/*
+ * File:   menu_trace.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:30
+ */
+
+#ifndef MENU_TRACE_H
+#define MENU_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Number of actions kept by the trace of a MenuController when MENU_TRACE is
+ * defined. Must be a power of 2.
+ */
+#ifndef MENU_TRACE_SIZE
+#define MENU_TRACE_SIZE 32
+#endif
+
+/**
+ * Public actions of the MenuController, i.e. the keys of the menu. BEGIN,
+ * COMMIT and ROLLBACK are the ones of transactions, BEGIN having no commit
+ * callback when queued.
+ */
+enum class MenuAction : uint8_t {
+    UP, DOWN, LEFT, RIGHT, ENTER, ESCAPE, PAGE_UP, PAGE_DOWN, HOME, END, SEEK,
+    UNDO, REDO, BEGIN, COMMIT, ROLLBACK
+};
+
+/**
+ * Time source for the trace, in whatever units the platform has at hand, e.g.
+ * micros() on Arduino. It may wrap around, durations are still right.
+ */
+typedef uint32_t (*MenuTraceClock)();
+
+//=============================================================================
+// MenuTrace
+//=============================================================================
+
+/** What is recorded of each action. */
+struct MenuTraceEntry {
+    uint32_t timestamp; // when the action started
+    uint32_t duration; // in units of the clock
+    uint16_t section; // ID of the section shown after the action
+    MenuAction action;
+    uint8_t result; // StateInfo::ActionResult
+};
+
+/**
+ * Ring buffer with the last SIZE actions done. The controller is the only
+ * writer, and it publishes every entry by advancing the head after writing it,
+ * with a compiler barrier in between as the one of MenuEventQueue, so it can
+ * be read without locks from elsewhere on the same core, e.g. a debug console.
+ * The reader reads the head before the entries, but one slower than the
+ * actions may see the oldest entries being overwritten. The head is 32 bit, so
+ * on 8 bit cores it must not be read from an interrupt of the writer.
+ */
+template<size_t SIZE>
+class MenuTrace {
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "trace size must be a power of 2");
+    MenuTraceEntry entries_[SIZE];
+    volatile uint32_t head_{0}; // number of entries ever recorded
+
+    /** Keep the compiler from moving memory accesses across it */
+    static void barrier() { __asm__ __volatile__("" ::: "memory"); }
+public:
+    void record(const MenuTraceEntry& entry) {
+        uint32_t head = head_;
+        entries_[head & (SIZE - 1)] = entry;
+        barrier();
+        head_ = head + 1;
+    }
+    /** Number of entries available, up to SIZE. */
+    size_t getCount() const { return head_ < SIZE ? head_ : SIZE; }
+    /** Total number of actions recorded, including the overwritten ones. */
+    uint32_t getTotal() const { return head_; }
+    /** Entry i, 0 being the oldest available. */
+    const MenuTraceEntry& get(size_t i) const {
+        uint32_t head = head_;
+        barrier();
+        return entries_[(head - (head < SIZE ? head : SIZE) + i) & (SIZE - 1)];
+    }
+    /** Entry of the slowest action available, or NULL if there is none. */
+    const MenuTraceEntry* getWorst() const {
+        const MenuTraceEntry* worst = NULL;
+        for (size_t i = 0; i < getCount(); i++) {
+            if (!worst || get(i).duration > worst->duration)
+                worst = &get(i);
+        }
+        return worst;
+    }
+    void clear() { head_ = 0; }
+};
+
+#endif /* MENU_TRACE_H */
@@ -0,0 +1,134 @@
+/*
+ * File:   menu_transaction.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:43
+ */
+
+#ifndef MENU_TRANSACTION_H
+#define MENU_TRANSACTION_H
+
+#include <cstdint>
+#include <cstring>
+#include "menu_item.h"
+#include "menu_section.h"
+
+/**
+ * Max number of different variables that the items of a section edited in a
+ * transaction can wrap.
+ */
+#ifndef MAX_TRANSACTION_VALUES
+#define MAX_TRANSACTION_VALUES 8
+#endif
+
+//=============================================================================
+// MenuTransaction
+//=============================================================================
+
+/**
+ * Edits all the items of a section at once. It works as the TempMenuItem, but
+ * for the whole section: open() swaps the variable of every item with a
+ * scratch copy, so that accepted edits only change the copies, and close()
+ * swaps them back, setting the new values only if the transaction is
+ * committed. Items wrapping the same variable share the same copy.
+ *
+ * The section must stay alive while the transaction is open.
+ */
+class MenuTransaction {
+    struct Value {
+        EndpointMenuItem* item; // first item wrapping the variable
+        void* source; // the variable
+        ValueUnion scratch;
+        bool changed; // set by the commit
+    };
+    Value values_[MAX_TRANSACTION_VALUES];
+    BaseMenuSection* section_{NULL};
+    uint8_t count_{0};
+
+    Value* find(void* source) {
+        for (uint8_t i = 0; i < count_; i++) {
+            if (values_[i].source == source)
+                return &values_[i];
+        }
+        return NULL;
+    }
+public:
+    bool isOpen() const { return section_ != NULL; }
+    BaseMenuSection* getSection() const { return section_; }
+    /**
+     * Start editing the items of section against scratch copies.
+     * @return false if they wrap more than MAX_TRANSACTION_VALUES variables,
+     * in which case nothing is changed
+     */
+    bool open(BaseMenuSection* section) {
+        AbstractMenuItem** items = section->getItems();
+        count_ = 0;
+        for (uint8_t i = 0; i < section->getSize(); i++) {
+            if (items[i]->isSection())
+                continue;
+            EndpointMenuItem* item = (EndpointMenuItem*)items[i];
+            if (find(item->getValuePointer()))
+                continue;
+            if (count_ == MAX_TRANSACTION_VALUES) {
+                count_ = 0;
+                return false;
+            }
+            values_[count_++] = {item, item->getValuePointer(), item->getValueUnion(), false};
+        }
+        for (uint8_t i = 0; i < section->getSize(); i++) {
+            if (items[i]->isSection())
+                continue;
+            EndpointMenuItem* item = (EndpointMenuItem*)items[i];
+            item->setValuePointer(&find(item->getValuePointer())->scratch);
+        }
+        section_ = section;
+        return true;
+    }
+    /**
+     * Swap back the variables of the items.
+     * @param commit set the variables to the new values
+     */
+    void close(bool commit) {
+        AbstractMenuItem** items = section_->getItems();
+        for (uint8_t i = 0; i < section_->getSize(); i++) {
+            if (items[i]->isSection())
+                continue;
+            EndpointMenuItem* item = (EndpointMenuItem*)items[i];
+            for (uint8_t j = 0; j < count_; j++) {
+                if (item->getValuePointer() == &values_[j].scratch) {
+                    item->setValuePointer(values_[j].source);
+                    break;
+                }
+            }
+        }
+        for (uint8_t i = 0; i < count_; i++) {
+            Value& value = values_[i];
+            value.changed = commit && memcmp(value.source, &value.scratch,
+                    value.item->getValueSize()) != 0;
+            if (value.changed)
+                value.item->setValueUnion(&value.scratch);
+        }
+        section_ = NULL;
+    }
+    /** Number of variables in the transaction */
+    uint8_t getCount() const { return count_; }
+    /**
+     * First item wrapping the variable i. While the transaction is open, it
+     * shows the new value.
+     */
+    EndpointMenuItem* getItem(uint8_t i) const { return values_[i].item; }
+    /** Variable i, which keeps the original value while the transaction is open */
+    const void* getSource(uint8_t i) const { return values_[i].source; }
+    /**
+     * Whether the new value of the variable i differs from the original, or
+     * once closed, whether the commit changed it.
+     */
+    bool isChanged(uint8_t i) const {
+        if (!isOpen())
+            return values_[i].changed;
+        return memcmp(values_[i].source, &values_[i].scratch,
+                values_[i].item->getValueSize()) != 0;
+    }
+};
+
+#endif /* MENU_TRANSACTION_H */
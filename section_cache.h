@@ -0,0 +1,127 @@
+/*
+ * File:   section_cache.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:18
+ */
+
+#ifndef SECTION_CACHE_H
+#define SECTION_CACHE_H
+
+#include <cstdint>
+#include "menu_factory.h"
+#include "menu_section.h"
+
+/**
+ * Max number of sections that a SectionCache can keep alive at the same time,
+ * regardless of its byte budget.
+ */
+#ifndef MAX_SECTION_CACHE_ENTRIES
+#define MAX_SECTION_CACHE_ENTRIES 4
+#endif
+
+//=============================================================================
+// SectionCache
+//=============================================================================
+
+/**
+ * Keeps sections alive after the MenuController leaves them, so that going
+ * back to them does not require building them again. Sections are looked up
+ * by ID and the least recently used ones are destroyed when the byte budget
+ * would be exceeded, or when the factory runs out of memory for new sections.
+ *
+ * Entries are kept sorted from most to least recently used, which is cheap
+ * given the small number of them.
+ */
+class SectionCache {
+    struct Entry {
+        BaseMenuSection* section;
+        size_t bytes;
+    };
+    Entry entries_[MAX_SECTION_CACHE_ENTRIES];
+    uint8_t count_{0};
+    const size_t budget_;
+    size_t used_{0};
+
+    void remove(uint8_t idx) {
+        used_ -= entries_[idx].bytes;
+        count_--;
+        for (uint8_t i = idx; i < count_; i++)
+            entries_[i] = entries_[i + 1];
+    }
+public:
+    /**
+     * @param budget max number of bytes taken by the sections kept. The bytes
+     * of each section are given by MenuFactory::getSectionBytes().
+     */
+    SectionCache(size_t budget) : budget_(budget) { }
+    /**
+     * Get a cached section, which is removed from the cache since it's going
+     * to be used again.
+     * @return the section, or NULL if it's not in the cache
+     */
+    BaseMenuSection* take(uint section) {
+        for (uint8_t i = 0; i < count_; i++) {
+            if (entries_[i].section->getId() == section) {
+                BaseMenuSection* found = entries_[i].section;
+                remove(i);
+                return found;
+            }
+        }
+        return NULL;
+    }
+    /**
+     * Keep a section that is not used anymore, evicting the least recently
+     * used ones as needed. If it does not fit at all it is destroyed.
+     */
+    void put(BaseMenuSection* section, MenuFactory& menu) {
+        size_t bytes = menu.getSectionBytes();
+        if (bytes > budget_) {
+            menu.destroySection(section);
+            return;
+        }
+        while (used_ + bytes > budget_ || count_ == MAX_SECTION_CACHE_ENTRIES)
+            evict(menu);
+        for (uint8_t i = count_; i > 0; i--)
+            entries_[i] = entries_[i - 1];
+        entries_[0] = {section, bytes};
+        used_ += bytes;
+        count_++;
+    }
+    /**
+     * Destroy the least recently used section.
+     * @return false if the cache was already empty
+     */
+    bool evict(MenuFactory& menu) {
+        if (count_ == 0)
+            return false;
+        BaseMenuSection* section = entries_[count_ - 1].section;
+        remove(count_ - 1);
+        menu.destroySection(section);
+        return true;
+    }
+    /**
+     * Have the items of the sections kept that wrap the variable format their
+     * value again, as it was changed while they were not in use.
+     */
+    void invalidate(const void* variable) {
+        for (uint8_t i = 0; i < count_; i++) {
+            BaseMenuSection* section = entries_[i].section;
+            AbstractMenuItem** items = section->getItems();
+            for (uint8_t j = 0; j < section->getSize(); j++) {
+                if (!items[j]->isSection()
+                        && ((EndpointMenuItem*)items[j])->getValuePointer() == variable)
+                    ((EndpointMenuItem*)items[j])->invalidateValueString();
+            }
+        }
+    }
+    /** Destroy all the sections kept. */
+    void clear(MenuFactory& menu) {
+        while (evict(menu)) { }
+    }
+    uint8_t getCount() const { return count_; }
+    size_t getBytesUsed() const { return used_; }
+    size_t getBudget() const { return budget_; }
+};
+
+#endif /* SECTION_CACHE_H */
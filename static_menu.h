@@ -0,0 +1,110 @@
+/*
+ * File:   static_menu.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:19
+ */
+
+#ifndef STATIC_MENU_H
+#define STATIC_MENU_H
+
+#include <cstdint>
+#include "menu_factory.h"
+#include "menu_section.h"
+
+//=============================================================================
+// StaticMenu
+//=============================================================================
+
+/**
+ * Checks at compile time that the ID of every section matches its position in
+ * the list, starting at ID. This way every ID in the range has a section and
+ * it can be looked up in a table.
+ */
+template<uint ID, typename... SECTIONS>
+struct SectionIdsInOrder {
+    static const bool value = true;
+};
+
+template<uint ID, typename S, typename... REST>
+struct SectionIdsInOrder<ID, S, REST...> {
+    static const bool value = S::id == ID && SectionIdsInOrder<ID + 1, REST...>::value;
+};
+
+/**
+ * Menu factory defined entirely at compile time by the list of its sections,
+ * which replaces the chain of ifs in createSection() with a constant table of
+ * constructors indexed by section ID.
+ *
+ * The sections must derive from SectionTemplate, be default constructible and
+ * be listed in order of ID starting at 0, which is the root. This is checked
+ * when compiling. Sections are built in a SectionArena with SLOTS slots.
+ */
+template<size_t SLOTS, typename... SECTIONS>
+class StaticMenu : public MenuFactory {
+    static_assert(sizeof...(SECTIONS) > 0, "a menu needs at least a root section");
+    static_assert(SectionIdsInOrder<0, SECTIONS...>::value,
+            "sections must be listed in order of ID, starting at 0");
+
+    typedef SectionArena<SLOTS, SECTIONS...> Arena;
+    typedef BaseMenuSection* (*Constructor)(Arena&);
+
+    template<typename S>
+    static BaseMenuSection* construct(Arena& arena) { return arena.template create<S>(); }
+
+    static const Constructor constructors_[sizeof...(SECTIONS)];
+    Arena arena_;
+public:
+    static const uint16_t section_count = sizeof...(SECTIONS);
+
+    /** Whether there is a section with that ID, usable in static_assert. */
+    static constexpr bool hasSection(uint16_t section) { return section < section_count; }
+
+    /**
+     * Create the section with that ID.
+     * @return NULL if there is no section with that ID, or no free slot
+     */
+    BaseMenuSection* createSection(uint16_t section) override {
+        if (!hasSection(section))
+            return NULL;
+        return constructors_[section](arena_);
+    }
+    BaseMenuSection* createRoot() override { return constructors_[0](arena_); }
+    void destroySection(BaseMenuSection* section) override { arena_.destroy(section); }
+    size_t getSectionBytes() const override { return Arena::getSlotSize(); }
+#ifdef DEBUG_MODE
+    /** Nothing to do by default, derived menus may override it */
+    void onPreDraw() override { }
+#endif
+    /**
+     * Whether the SectionMenuItems of every section lead to a section of the
+     * menu, which cannot be checked when compiling. It builds each section in
+     * turn, so it needs a free slot: call it once on startup, before creating
+     * the controller.
+     */
+    bool checkLinks() {
+        for (uint16_t id = 0; id < section_count; id++) {
+            BaseMenuSection* section = constructors_[id](arena_);
+            if (!section)
+                return false;
+            AbstractMenuItem** items = section->getItems();
+            bool valid = true;
+            for (uint8_t i = 0; valid && i < section->getSize(); i++) {
+                valid = !items[i]->isSection()
+                        || hasSection(((SectionMenuItem*)items[i])->getSectionId());
+            }
+            arena_.destroy(section);
+            if (!valid)
+                return false;
+        }
+        return true;
+    }
+};
+
+template<size_t SLOTS, typename... SECTIONS>
+const typename StaticMenu<SLOTS, SECTIONS...>::Constructor
+StaticMenu<SLOTS, SECTIONS...>::constructors_[sizeof...(SECTIONS)] {
+    &StaticMenu<SLOTS, SECTIONS...>::template construct<SECTIONS>...
+};
+
+#endif /* STATIC_MENU_H */
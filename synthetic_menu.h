@@ -0,0 +1,187 @@
+/*
+ * File:   synthetic_menu.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:28
+ */
+
+#ifndef SYNTHETIC_MENU_H
+#define SYNTHETIC_MENU_H
+
+#include <cstdint>
+#include "utility.h"
+#include "menu_factory.h"
+#include "menu_item.h"
+#include "menu_section.h"
+
+/**
+ * Item types that a synthetic menu can use for its values, combined as bit
+ * flags in the MIX parameter of SyntheticMenu.
+ */
+enum SyntheticMix : uint8_t {
+    SYNTHETIC_INT32 = 0x01,
+    SYNTHETIC_FLOAT32 = 0x02,
+    SYNTHETIC_FIXED32 = 0x04,
+    SYNTHETIC_BOOL = 0x08,
+    SYNTHETIC_ALL = 0x0F
+};
+
+/** Storage for the value of any item of a synthetic menu. */
+union SyntheticValue {
+    int32_t integer;
+    float real;
+    bool boolean;
+};
+
+//=============================================================================
+// SyntheticSection
+//=============================================================================
+
+/**
+ * Section whose items are chosen at runtime: first the links to its children,
+ * if it has any, then ITEMS values whose types rotate through the mix given.
+ * Items are built in place in the section, so it never touches the heap.
+ */
+template<uint8_t ITEMS, uint8_t FANOUT>
+class SyntheticSection : public BaseMenuSection {
+    static_assert(ITEMS + FANOUT > 0, "a section needs at least one item");
+    static_assert(ITEMS + FANOUT <= UINT8_MAX, "too many items in a section");
+
+    typedef MaxSizeOf<SectionMenuItem, Int32MenuItem, Float32MenuItem,
+            Fixed32MenuItem, BoolMenuItem> ItemSize;
+    struct Slot {
+        alignas(ItemSize::align) unsigned char mem[ItemSize::size];
+    };
+    Slot slots_[ITEMS + FANOUT];
+    AbstractMenuItem* items_[ITEMS + FANOUT];
+    uint8_t size_{0};
+
+    AbstractMenuItem* createValueItem(SyntheticMix type, SyntheticValue* value,
+            uint16_t value_id) {
+        void* mem = slots_[size_].mem;
+        switch (type) {
+        case SYNTHETIC_INT32:
+            return new (mem) Int32MenuItem(true, "Int32", &value->integer,
+                    {-100000, 100000, 0}, value_id);
+        case SYNTHETIC_FLOAT32:
+            return new (mem) Float32MenuItem(true, "Float32", &value->real,
+                    {-1E3, 1E3, 0}, 2, value_id);
+        case SYNTHETIC_FIXED32:
+            return new (mem) Fixed32MenuItem(true, "Fixed32", &value->integer,
+                    {0, 100000, 0}, 2, value_id);
+        default:
+            return new (mem) BoolMenuItem(true, "Bool", &value->boolean, value_id);
+        }
+    }
+public:
+    /**
+     * @param section ID of the section
+     * @param first_child ID of the first child, the rest follow it
+     * @param children number of children, 0 for the leaves
+     * @param values storage for the ITEMS values of the section
+     * @param mix types of the values, in the order they are used
+     */
+    SyntheticSection(uint16_t section, uint16_t first_child, uint8_t children,
+            SyntheticValue* values, const SyntheticMix* mix, uint8_t mix_size)
+        : BaseMenuSection(section) {
+        for (uint8_t i = 0; i < children; i++, size_++)
+            items_[size_] = new (slots_[size_].mem) SectionMenuItem(first_child + i,
+                    true, "Section");
+        for (uint8_t i = 0; i < ITEMS; i++, size_++)
+            items_[size_] = createValueItem(mix[(section + i) % mix_size], &values[i],
+                    section * ITEMS + i);
+    }
+    ~SyntheticSection() {
+        // through the concrete types, as the destructors are not virtual with
+        // MENU_STATIC_DISPATCH
+        for (uint8_t i = 0; i < size_; i++) {
+            switch (items_[i]->getType()) {
+            case MenuItemType::section:
+                ((SectionMenuItem*)items_[i])->~SectionMenuItem();
+                break;
+            case MenuItemType::int32:
+                ((Int32MenuItem*)items_[i])->~Int32MenuItem();
+                break;
+            case MenuItemType::float32:
+                ((Float32MenuItem*)items_[i])->~Float32MenuItem();
+                break;
+            case MenuItemType::fixed32:
+                ((Fixed32MenuItem*)items_[i])->~Fixed32MenuItem();
+                break;
+            default:
+                ((BoolMenuItem*)items_[i])->~BoolMenuItem();
+                break;
+            }
+        }
+    }
+    uint8_t getSize() override { return size_; }
+    AbstractMenuItem** getItems() override { return items_; }
+};
+
+//=============================================================================
+// SyntheticMenu
+//=============================================================================
+
+/** Number of sections of a complete tree with that depth and fan-out. */
+constexpr uint32_t syntheticSectionCount(uint8_t depth, uint8_t fanout) {
+    return depth == 0 ? 0 : 1 + fanout * syntheticSectionCount(depth - 1, fanout);
+}
+
+/**
+ * Menu generated from its shape, for measuring how navigation and memory
+ * scale with the size of the menu. It is a complete tree of DEPTH levels in
+ * which every section but the leaves has FANOUT children, and every section
+ * has ITEMS values of the types selected in MIX.
+ *
+ * Sections are numbered level by level, so the children of section N are
+ * N*FANOUT+1 to N*FANOUT+FANOUT. The values of all the sections are kept by
+ * the factory, and item N of section S gets the value ID S*ITEMS+N.
+ */
+template<uint8_t DEPTH, uint8_t FANOUT, uint8_t ITEMS, uint8_t MIX = SYNTHETIC_ALL,
+        size_t SLOTS = 1>
+class SyntheticMenu : public MenuFactory {
+    static_assert(DEPTH > 0, "a menu needs at least a root section");
+    static_assert((MIX & SYNTHETIC_ALL) != 0, "no item types in the mix");
+    static_assert(syntheticSectionCount(DEPTH, FANOUT) <= UINT16_MAX,
+            "too many sections for 16 bit section IDs");
+    static_assert(syntheticSectionCount(DEPTH, FANOUT) * ITEMS <= UINT16_MAX + 1,
+            "too many values for 16 bit value IDs");
+public:
+    typedef SyntheticSection<ITEMS, FANOUT> Section;
+    static const uint16_t section_count = syntheticSectionCount(DEPTH, FANOUT);
+    static const uint32_t value_count = section_count * ITEMS;
+private:
+    SectionArena<SLOTS, Section> arena_;
+    SyntheticValue values_[value_count + 1]; // +1 to allow ITEMS == 0
+    SyntheticMix mix_[4];
+    uint8_t mix_size_{0};
+public:
+    SyntheticMenu() : values_() {
+        for (uint8_t type = SYNTHETIC_INT32; type & SYNTHETIC_ALL; type <<= 1) {
+            if (MIX & type)
+                mix_[mix_size_++] = (SyntheticMix)type;
+        }
+    }
+    /**
+     * Create the section with that ID.
+     * @return NULL if there is no section with that ID, or no free slot
+     */
+    BaseMenuSection* createSection(uint16_t section) override {
+        if (section >= section_count)
+            return NULL;
+        uint32_t first_child = (uint32_t)section * FANOUT + 1;
+        uint8_t children = first_child < section_count ? FANOUT : 0;
+        return arena_.template create<Section>(section, first_child, children,
+                &values_[section * ITEMS], mix_, mix_size_);
+    }
+    BaseMenuSection* createRoot() override { return createSection(0); }
+    void destroySection(BaseMenuSection* section) override { arena_.destroy(section); }
+    size_t getSectionBytes() const override { return arena_.getSlotSize(); }
+#ifdef DEBUG_MODE
+    void onPreDraw() override { }
+#endif
+    /** Value with ID value_id, for checking the effect of edits */
+    SyntheticValue& getValue(uint16_t value_id) { return values_[value_id]; }
+};
+
+#endif /* SYNTHETIC_MENU_H */
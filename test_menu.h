@@ -8,8 +8,9 @@
 #ifndef TEST_MENU_H
 #define TEST_MENU_H
 
-#include "menu_factory.h"
 #include "menu_section.h"
+#include "static_menu.h"
+#include "value_registry.h"
 
 // used so that the PROGMEM keyword doesn't result in an error when compiling with g++
 #define PROGMEM
@@ -18,6 +19,7 @@ enum EventId {
 	EEPROM_BOOL_VAR,
 	EEPROM_FLOAT_VAR,
 	EEPROM_UINT_VAR,
+	EEPROM_FIXED_VAR,
 };
 
 enum SectionId {
@@ -30,9 +32,19 @@ struct AppManager {
 	bool boolean{false};
 	float floating{500};
 	uint32_t uinteger{300};
+	int32_t fixed{1250}; // hundredths
 };
 static AppManager app_mgr;
 
+// variables of app_mgr by value ID, for loading and saving them all at once
+static const ValueEntry app_values[] {
+	{&app_mgr.boolean, EEPROM_BOOL_VAR, MenuItemType::boolean},
+	{&app_mgr.floating, EEPROM_FLOAT_VAR, MenuItemType::float32},
+	{&app_mgr.uinteger, EEPROM_UINT_VAR, MenuItemType::sel32u},
+	{&app_mgr.fixed, EEPROM_FIXED_VAR, MenuItemType::fixed32},
+};
+static const ValueRegistry app_registry(app_values);
+
 //=============================================================================
 // Sections
 //=============================================================================
@@ -51,7 +63,7 @@ public:
 
 //========== Settings Section ===========
 
-class SettingsSection : public SectionTemplate<NoCtx, NoOnExit, 4, SETTINGS> {
+class SettingsSection : public SectionTemplate<NoCtx, NoOnExit, 5, SETTINGS> {
     AppManager& app_mgr_;
 	// menu strings can be defined in the section class itself
     static constexpr const char *bluetooth_info PROGMEM {"Bluetooth"};
@@ -60,6 +72,7 @@ class SettingsSection : public SectionTemplate<NoCtx, NoOnExit, 4, SETTINGS> {
     static constexpr const char *s1h PROGMEM {"1h"};
 	static constexpr const char *cont_thres_info PROGMEM {"Cont. threshold"};
     static constexpr const char *continuity_info PROGMEM {"Continuity"};
+    static constexpr const char *voltage_info PROGMEM {"Voltage"};
 	// option 1: does not work with the linker -- silly error/bug!!
     // static constexpr const char *idle_timeout_labels[] {s5m, s1h};
     // static constexpr const uint32_t idle_timeout_values[2] {300, 3600};
@@ -74,10 +87,12 @@ class SettingsSection : public SectionTemplate<NoCtx, NoOnExit, 4, SETTINGS> {
 		&app_mgr_.uinteger,	idle_timeout_labels, idle_timeout_values, 2, EEPROM_UINT_VAR);
 	Float32MenuItem cont_thres{true, cont_thres_info, &app_mgr_.floating, {0, 1E3, 0}, 2, EEPROM_FLOAT_VAR};
     BoolMenuItem continuity{true, continuity_info, &app_mgr_.boolean, EEPROM_BOOL_VAR};
+    // decimal value without floating point: 0.00 to 50.00
+    Fixed32MenuItem voltage{true, voltage_info, &app_mgr_.fixed, {0, 5000, 0}, 2, EEPROM_FIXED_VAR};
 
 public:
-    SettingsSection(AppManager& app_mgr)
-		: SectionTemplate({&bluetooth, &idle_timeout, &cont_thres, &continuity})
+    SettingsSection(AppManager& app_mgr = ::app_mgr)
+		: SectionTemplate({&bluetooth, &idle_timeout, &cont_thres, &continuity, &voltage})
 		, app_mgr_(app_mgr) { }
 };
 // for option 2
@@ -90,18 +105,11 @@ const char *SettingsSection::idle_timeout_labels[] {SettingsSection::s5m,
 // TestMenu
 //=============================================================================
 
-class TestMenu : public MenuFactory {
+// sections listed in order of ID. One arena slot for the current section plus
+// another to cache its parent
+class TestMenu : public StaticMenu<2, RootSection, SettingsSection> {
 public:
     ~TestMenu() { }
-    BaseMenuSection* createSection(uint16_t section) override {
-        if (ROOT == section)
-            return new RootSection();
-        if (SETTINGS == section)
-            return new SettingsSection(app_mgr);
-		// TODO: change this so that an invalid id fails compiling
-        return NULL; // should never happen -- crashes the program
-    }
-    BaseMenuSection* createRoot() override { return new RootSection(); }
 #ifdef DEBUG_MODE
     virtual void onPreDraw() { }
 #endif
@@ -11,12 +11,33 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+#include <cstddef>
 #include <cstdint>
-#include <cstdio>
 #include <cstring>
 
 static const char *off_limits = "OffLimits";
 
+/**
+ * Compile-time maximum of the sizes and alignments of a list of types. Used to
+ * size static storage able to hold any of them.
+ */
+template<typename... TYPES>
+struct MaxSizeOf;
+
+template<typename T>
+struct MaxSizeOf<T> {
+    static const size_t size = sizeof(T);
+    static const size_t align = alignof(T);
+};
+
+template<typename T, typename... REST>
+struct MaxSizeOf<T, REST...> {
+    static const size_t size = sizeof(T) > MaxSizeOf<REST...>::size
+        ? sizeof(T) : MaxSizeOf<REST...>::size;
+    static const size_t align = alignof(T) > MaxSizeOf<REST...>::align
+        ? alignof(T) : MaxSizeOf<REST...>::align;
+};
+
 /**
  * Using this because I cannot use the abs function for float's of cmath due to
  * a bug in the gcc version of minsys.
@@ -114,6 +135,204 @@ inline int8_t sciexp(int32_t value) {
                                  return 10;
 }
 
+/** Same as sciexp() for 64 bit values, up to 19 digits */
+inline int8_t sciexp64(int64_t value) {
+    uint64_t magnitude = value < 0 ? 0u - (uint64_t)value : value;
+    int8_t digits = 1;
+    for (; magnitude >= 1000000000; magnitude /= 1000000000)
+        digits += 9;
+    return digits - 1 + sciexp((int32_t)magnitude);
+}
+
+/** Same as base10pow() for 64 bit values, with exp_ up to 18 */
+inline int64_t base10pow64(uint8_t exp_) {
+    return exp_ <= 9 ? base10pow(exp_) : base10pow(exp_ - 9) * (int64_t)1000000000;
+}
+
+/**
+ * Copy the error string into the buffer, truncated and always terminated.
+ */
+inline void copyOffLimits(char *buf, size_t sz) {
+    if (sz == 0)
+        return;
+    strncpy(buf, off_limits, sz);
+    buf[sz - 1] = '\0';
+}
+
+/**
+ * Pairs of decimal digits from "00" to "99", for converting integers to text
+ * two digits at a time, which halves the number of divisions.
+ */
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * Write the decimal digits of value backwards, ending right before end. It is
+ * the basic building block of the integer to string conversions.
+ *
+ * @return pointer to the first digit written
+ */
+inline char* utoaDecRev(char *end, uint32_t value) {
+    while (value >= 100) {
+        uint8_t pair = (value % 100) * 2;
+        value /= 100;
+        *--end = digit_pairs[pair + 1];
+        *--end = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--end = digit_pairs[value * 2 + 1];
+        *--end = digit_pairs[value * 2];
+    } else {
+        *--end = '0' + value;
+    }
+    return end;
+}
+
+/**
+ * Get the decimal string representation of a sign and magnitude, zero-padded
+ * to width digits. Returns the number of chars written, and a value of 0 means
+ * a failure, in which case a short error string is copied into the buffer.
+ */
+inline uint8_t itoaDecBase(char *buf, size_t sz, bool negative, const char *digits,
+        uint8_t len, uint8_t width) {
+    uint8_t pad = width > len ? width - len : 0;
+    uint8_t total = negative + pad + len;
+    if (total >= sz) {
+        copyOffLimits(buf, sz);
+        return 0;
+    }
+    uint8_t i = 0;
+    if (negative)
+        buf[i++] = '-';
+    for (; pad > 0; pad--)
+        buf[i++] = '0';
+    memcpy(&buf[i], digits, len);
+    buf[total] = '\0';
+    return total;
+}
+
+inline uint8_t itoaDecBase(char *buf, size_t sz, bool negative, uint32_t magnitude,
+        uint8_t width) {
+    char tmp[10];
+    char *digits = utoaDecRev(tmp + sizeof(tmp), magnitude);
+    return itoaDecBase(buf, sz, negative, digits, tmp + sizeof(tmp) - digits, width);
+}
+
+/**
+ * Get the string representation of an unsigned integer without using printf.
+ *
+ * @param buf destination buffer
+ * @param sz sizeof(buffer)
+ * @param value value to convert to string
+ * @param width min number of digits, padding with zeros on the left
+ *
+ * @return the number of chars written, 0 means a failure
+ */
+inline uint8_t utoaDec(char *buf, size_t sz, uint32_t value, uint8_t width = 0) {
+    return itoaDecBase(buf, sz, false, value, width);
+}
+
+/**
+ * Get the string representation of a signed integer without using printf.
+ *
+ * @param buf destination buffer
+ * @param sz sizeof(buffer)
+ * @param value value to convert to string
+ * @param width min number of digits, padding with zeros on the left
+ *
+ * @return the number of chars written, 0 means a failure
+ */
+inline uint8_t itoaDec(char *buf, size_t sz, int32_t value, uint8_t width = 0) {
+    // negate as unsigned so that INT32_MIN works too
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : value;
+    return itoaDecBase(buf, sz, value < 0, magnitude, width);
+}
+
+/**
+ * Get the string representation of a 64 bit signed integer without using
+ * printf. The digits are converted 9 at a time with 32 bit arithmetic, so
+ * that small cores without 64 bit division only pay for it once per chunk.
+ *
+ * @return the number of chars written, 0 means a failure
+ */
+inline uint8_t itoaDec64(char *buf, size_t sz, int64_t value, uint8_t width = 0) {
+    uint64_t magnitude = value < 0 ? 0u - (uint64_t)value : value;
+    char tmp[20];
+    char *digits = tmp + sizeof(tmp);
+    while (magnitude > UINT32_MAX) {
+        char *chunk = digits - 9;
+        digits = utoaDecRev(digits, (uint32_t)(magnitude % 1000000000));
+        while (digits > chunk)
+            *--digits = '0';
+        magnitude /= 1000000000;
+    }
+    digits = utoaDecRev(digits, (uint32_t)magnitude);
+    return itoaDecBase(buf, sz, value < 0, digits, tmp + sizeof(tmp) - digits, width);
+}
+
+/*
+ * Overloads of the integer conversions for each integer type wrapped by the
+ * items, so that templates get the right one without ambiguities.
+ */
+inline uint8_t intToDec(char *buf, size_t sz, uint16_t value) { return utoaDec(buf, sz, value); }
+inline uint8_t intToDec(char *buf, size_t sz, int32_t value) { return itoaDec(buf, sz, value); }
+inline uint8_t intToDec(char *buf, size_t sz, uint32_t value) { return utoaDec(buf, sz, value); }
+inline uint8_t intToDec(char *buf, size_t sz, int64_t value) { return itoaDec64(buf, sz, value); }
+inline int8_t intDigits(uint16_t value) { return sciexp(value); }
+inline int8_t intDigits(int32_t value) { return sciexp(value); }
+inline int8_t intDigits(uint32_t value) { return sciexp64(value); }
+inline int8_t intDigits(int64_t value) { return sciexp64(value); }
+
+/*
+ * Digits of the integer part of the decimal values wrapped by the items, as
+ * printed by ftoaFix(). Values out of its range count as the widest one.
+ */
+inline int8_t decDigits(float value) {
+    return value < 2147483648.0f && value > -2147483648.0f ? sciexp((int32_t)value) : 10;
+}
+inline int8_t decDigits(double value) {
+    return value < 1e18 && value > -1e18 ? sciexp64((int64_t)value) : 18;
+}
+
+/**
+ * Get the string representation of a fixed-point number, i.e. an integer with
+ * an implicit decimal point, e.g. 12345 with 2 decimals is "123.45".
+ *
+ * @param buf destination buffer
+ * @param sz sizeof(buffer)
+ * @param value scaled value to convert to string
+ * @param decimals number of digits after the decimal point, up to 9
+ *
+ * @return the number of chars written, 0 means a failure
+ */
+inline uint8_t itoaFix(char *buf, size_t sz, int32_t value, uint8_t decimals) {
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : value;
+    if (decimals == 0)
+        return itoaDecBase(buf, sz, value < 0, magnitude, 0);
+    uint32_t scale = base10pow(decimals);
+    uint8_t i = itoaDecBase(buf, sz, value < 0, magnitude / scale, 0);
+    if (i == 0 || (size_t)i + 1 >= sz) {
+        copyOffLimits(buf, sz);
+        return 0;
+    }
+    buf[i++] = '.';
+    uint8_t j = utoaDec(&buf[i], sz - i, magnitude % scale, decimals);
+    if (j == 0) {
+        copyOffLimits(buf, sz);
+        return 0;
+    }
+    return i + j;
+}
+
 /**
  * Return the exponent for scientific notation of a float value, i.e.
  * floor(log10(value)).
@@ -211,16 +430,11 @@ static uint8_t ftoaEngBase(char *buf, size_t sz, int8_t *exp, T value, int8_t pr
     }
     intp = (int16_t) value;
 	int8_t rest = precision - sciexp(intp);
-	uint8_t i;
-	if (negative)
-		i = sprintf(buf, "-%d", intp);
-	else
-		i = sprintf(buf, "%d", intp);
+	uint8_t i = itoaDecBase(buf, sz, negative, intp, 0);
 	if (rest > 0) {
 		decp = (value - (T) intp) * (T) base10pow(rest); // move comma right
-		char format[7];
-		sprintf(format, ".%%0%dd", rest);
-		i += sprintf(&buf[i], format, decp);
+		buf[i++] = '.';
+		i += utoaDec(&buf[i], sz - i, decp, rest);
 	}
 	*exp = exp_;
     return i; // chars written
@@ -243,13 +457,14 @@ static uint8_t ftoaEngBase(char *buf, size_t sz, int8_t *exp, T value, int8_t pr
 template<typename T>
 inline uint8_t ftoaEngExp(char *buf, size_t sz, int8_t *exp, T value, int8_t precision = 3) {
     const char *err = off_limits;
-	if (sz < precision + 7) { // precision + '-', '.', '\0', 'E-XX'
+	if (sz < (size_t)precision + 7) { // precision + '-', '.', '\0', 'E-XX'
 		buf[0] = '\0';
 		return 0;
 	}
 	uint8_t i = ftoaEngBase<T>(buf, sz, exp, value, precision);
 	if (i != 0) {
-		i += sprintf(&buf[i], "e%d", *exp);
+		buf[i++] = 'e';
+		i += itoaDec(&buf[i], sz - i, *exp);
 	} else {
 		strncpy(buf, err, sz);
 	}
@@ -273,7 +488,7 @@ inline uint8_t ftoaEngExp(char *buf, size_t sz, int8_t *exp, T value, int8_t pre
 template<typename T>
 inline uint8_t ftoaEng(char *buf, size_t sz, int8_t *exp, T value, int8_t precision = 3) {
     const char *err = off_limits;
-	if (sz < precision + 3) { // precision + '-', '.', '\0'
+	if (sz < (size_t)precision + 3) { // precision + '-', '.', '\0'
 		buf[0] = '\0';
 		return 0;
 	}
@@ -295,32 +510,58 @@ inline uint8_t ftoaEng(char *buf, size_t sz, int8_t *exp, T value, int8_t precis
  */
 template<typename T>
 inline uint8_t ftoaFix(char *buf, uint8_t sz, T value, uint8_t precision) {
-    const char *err = off_limits;
     int32_t intp; // int part
     int32_t decp; // decimal part
 
+    // the int part must fit in intp, which also rules out NaN
+    if (!(value < 2147483648.0f && value > -2147483648.0f)) {
+		copyOffLimits(buf, sz);
+		return 0;
+    }
     intp = (int32_t) value;
-	decp = (value - (float) intp) * fbase10pow<T>(precision); // move comma right
+	decp = (value - (T) intp) * fbase10pow<T>(precision); // move comma right
 	uint8_t intplen = sciexp(intp);
-	uint8_t decplen = sciexp(decp);
-	if (intplen + decplen + 3 > sz ) { // int len + dec len + '.' + '-' + '\0'
-		strncpy(buf, err, sz);
+	// check both parts so that the minus gets written even if intp = 0
+	bool negative = intp < 0 || decp < 0;
+	// '-' + int len + '.' + decimals, at least one, + '\0'
+	if (negative + intplen + (precision > 0 ? precision : 1) + 2 > sz) {
+		copyOffLimits(buf, sz);
 		return 0;
 	}
-	uint8_t i;
-	char format[8];
-	sprintf(format, ".%%0%dld", precision);
-	if (decp < 0) {
-		i = sprintf(buf, "-%d", -intp); // so that the minus gets written even if intp = 0
-		sprintf(&buf[i], format, -decp);
-	}
-	else {
-		i = sprintf(buf, "%d", intp);
-		sprintf(&buf[i], format, decp);
-	}
+	uint8_t i = itoaDecBase(buf, sz, negative, negative ? -intp : intp, 0);
+	buf[i++] = '.';
+	i += utoaDec(&buf[i], sz - i, negative ? -decp : decp, precision);
 	return i;
 }
 
+/**
+ * Same as ftoaFix() for doubles, whose int part is kept in 64 bits so that
+ * it can have up to 18 digits. Bigger values, or more than 9 decimals, give
+ * the error string.
+ */
+inline uint8_t ftoaFix(char *buf, uint8_t sz, double value, uint8_t precision) {
+    if (!(value < 1e18 && value > -1e18) || precision > 9) {
+        copyOffLimits(buf, sz);
+        return 0;
+    }
+    int64_t intp = (int64_t) value; // int part
+    int32_t decp = (value - (double) intp) * fbase10pow<double>(precision); // decimal part
+    // check both parts so that the minus gets written even if intp = 0
+    bool negative = intp < 0 || decp < 0;
+    // '-' + int len + '.' + decimals, at least one, + '\0'
+    if (negative + sciexp64(intp) + (precision > 0 ? precision : 1) + 2 > sz) {
+        copyOffLimits(buf, sz);
+        return 0;
+    }
+    uint8_t i = 0;
+    if (negative)
+        buf[i++] = '-';
+    i += itoaDec64(&buf[i], sz - i, negative ? -intp : intp);
+    buf[i++] = '.';
+    i += utoaDec(&buf[i], sz - i, negative ? -decp : decp, precision);
+    return i;
+}
+
 /**
  * Returns the string representation of a float number in pseudo fixed-point notation.
  *
@@ -346,21 +587,19 @@ inline uint8_t ftoaFix2(char *buf, uint8_t sz, T value, uint8_t digits) {
 			strncpy(buf, err, sz);
 			return 0;
 		}
-		i = sprintf(buf, "%ld", intp);
+		i = itoaDec(buf, sz, intp);
 	}
     else {
         decp = (value - (float) intp) * fbase10pow<T>(aux); // move comma right
 		uint8_t decplen = sciexp(decp);
 		if (intplen + decplen + 2 >= sz ) { // int len + dec len + '.' + '-'
 			strncpy(buf, err, sz);
-			return;
+			return 0;
 		}
-		char format[9];
-		sprintf(format, "-%%ld.%%0%dd", aux);
-		if (decp < 0)
-			i = sprintf(buf, format, -intp, -decp);
-		else
-			i = sprintf(buf, &format[1], intp, decp);
+		bool negative = intp < 0 || decp < 0;
+		i = itoaDecBase(buf, sz, negative, negative ? -intp : intp, 0);
+		buf[i++] = '.';
+		i += utoaDec(&buf[i], sz - i, negative ? -decp : decp, aux);
 	}
 	return i;
 }
@@ -400,16 +639,11 @@ static uint8_t ftoaSciBase(char *buf, size_t sz, int8_t *exp, T value, int8_t pr
     value = value * fbase10pow<T>(-exp_); // move comma an amount `exp_`
     intp = (int8_t) value;
     int8_t rest = precision - 1; // number of decimals
-	uint8_t i;
-	if (negative)
-		i = sprintf(buf, "-%d", intp);
-	else
-		i = sprintf(buf, "%d", intp);
+	uint8_t i = itoaDecBase(buf, sz, negative, intp, 0);
 	if (rest > 0) {
 		decp = (value - (T) intp) * (T) base10pow(rest); // move comma right
-		char format[7];
-		sprintf(format, ".%%0%dd", rest);
-		i += sprintf(&buf[i], format, decp);
+		buf[i++] = '.';
+		i += utoaDec(&buf[i], sz - i, decp, rest);
 	}
 	*exp = exp_;
     return i; // chars written
@@ -432,13 +666,14 @@ static uint8_t ftoaSciBase(char *buf, size_t sz, int8_t *exp, T value, int8_t pr
 template<typename T>
 inline uint8_t ftoaSciExp(char *buf, size_t sz, int8_t *exp, T value, int8_t precision) {
     const char *err = off_limits;
-	if (sz < precision + 7) { // precision + '-', '.', '\0', 'E-XX'
+	if (sz < (size_t)precision + 7) { // precision + '-', '.', '\0', 'E-XX'
 		buf[0] = '\0';
 		return 0;
 	}
 	uint8_t i = ftoaSciBase<T>(buf, sz, exp, value, precision);
 	if (i != 0) {
-		i += sprintf(&buf[i], "e%d", *exp);
+		buf[i++] = 'e';
+		i += itoaDec(&buf[i], sz - i, *exp);
 	} else {
 		strncpy(buf, err, sz);
 	}
@@ -462,7 +697,7 @@ inline uint8_t ftoaSciExp(char *buf, size_t sz, int8_t *exp, T value, int8_t pre
 template<typename T>
 inline uint8_t ftoaSci(char *buf, size_t sz, int8_t *exp, T value, int8_t precision) {
     const char *err = off_limits;
-	if (sz < precision + 3) { // precision + '-', '.', '\0'
+	if (sz < (size_t)precision + 3) { // precision + '-', '.', '\0'
 		buf[0] = '\0';
 		return 0;
 	}
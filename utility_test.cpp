@@ -5,8 +5,10 @@
  * Created on 23 de abril de 2016, 17:53
  */
 
+#include <cassert>
 #include <cstdlib>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include "utility.h"
 
@@ -25,28 +27,33 @@ void test_ftoaEng() {
     cout << value << endl;
     ftoaEng(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "10.203") == 0 && exp == 3);
 
     value = 1.02030405E-4;
     cout << "1.0 > value > 0.0" << endl;
     cout << value << endl;
     ftoaEng(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "102.03") == 0 && exp == -6);
 
     value = -1.02030405E-4;
     cout << "0.0 > value > -1.0" << endl;
     cout << value << endl;
     ftoaEng(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "-102.03") == 0 && exp == -6);
 
     value = -1.02030405E4;
     cout << "-1.0 > value" << endl;
     cout << value << endl;
     ftoaEng(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "-10.203") == 0 && exp == 3);
 
     cout << "Short buffer test:" << endl;
     ftoaEng(buf, sizeof(buf), &exp, value, digits);
     cout << "Result: " << buf << endl << endl;
+    assert(strcmp(buf, "-10.203") == 0);
 }
 
 void test_ftoaEngExp() {
@@ -62,28 +69,33 @@ void test_ftoaEngExp() {
     cout << value << endl;
     ftoaEngExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "10.203e3") == 0);
 
     value = 1.02030405E-4;
     cout << "1.0 > value > 0.0" << endl;
     cout << value << endl;
     ftoaEngExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "102.03e-6") == 0);
 
     value = -1.02030405E-4;
     cout << "0.0 > value > -1.0" << endl;
     cout << value << endl;
     ftoaEngExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "-102.03e-6") == 0);
 
     value = -1.02030405E4;
     cout << "-1.0 > value" << endl;
     cout << value << endl;
     ftoaEngExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "-10.203e3") == 0);
 
     cout << "Short buffer test:" << endl;
     ftoaEng(buf, sizeof(buf), &exp, value, digits);
     cout << "Result: " << buf << endl << endl;
+    assert(strcmp(buf, "-10.203") == 0);
 }
 
 void test_ftoaFix() {
@@ -98,24 +110,28 @@ void test_ftoaFix() {
     cout << value << endl;
     ftoaFix(buf, sizeof(buf), value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "123.449996") == 0);
 
     value = 1.2345E-2;
     cout << "1.0 > value > 0.0" << endl;
     cout << value << endl;
     ftoaFix(buf, sizeof(buf), value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "0.012345") == 0);
 
     value = -1.2345E-2;
     cout << "0.0 > value > -1.0" << endl;
     cout << value << endl;
     ftoaFix(buf, sizeof(buf), value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "-0.012345") == 0);
 
     value = -1.2345E2;
     cout << "-1.0 > value" << endl;
     cout << value << endl;
     ftoaFix(buf, sizeof(buf), value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "-123.449996") == 0);
 }
 
 void test_ftoaSci() {
@@ -131,28 +147,33 @@ void test_ftoaSci() {
     cout << value << endl;
     ftoaSci(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "1.234") == 0 && exp == 5);
 
     value = 1.2345E-5;
     cout << "1.0 > value > 0.0" << endl;
     cout << value << endl;
     ftoaSci(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "1.234") == 0 && exp == -5);
 
     value = -1.2345E-5;
     cout << "0.0 > value > -1.0" << endl;
     cout << value << endl;
     ftoaSci(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "-1.234") == 0 && exp == -5);
 
     value = -1.2345E5;
     cout << "-1.0 > value" << endl;
     cout << value << endl;
     ftoaSci(buf, sizeof(buf), &exp, value, digits);
     cout << buf << 'E' << (int)exp << endl << endl;
+    assert(strcmp(buf, "-1.234") == 0 && exp == 5);
 
     cout << "Short buffer test:" << endl;
     ftoaSci(buf, sizeof(buf), &exp, value, digits);
     cout << "Result: " << buf << endl << endl;
+    assert(strcmp(buf, "-1.234") == 0);
 }
 
 void test_ftoaSciExp() {
@@ -168,36 +189,145 @@ void test_ftoaSciExp() {
     cout << value << endl;
     ftoaSciExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "1.234e5") == 0);
 
     value = 1.2345E-5;
     cout << "1.0 > value > 0.0" << endl;
     cout << value << endl;
     ftoaSciExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "1.234e-5") == 0);
 
     value = -1.2345E-5;
     cout << "0.0 > value > -1.0" << endl;
     cout << value << endl;
     ftoaSciExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "-1.234e-5") == 0);
 
     value = -1.2345E5;
     cout << "-1.0 > value" << endl;
     cout << value << endl;
     ftoaSciExp(buf, sizeof(buf), &exp, value, digits);
     cout << buf << endl << endl;
+    assert(strcmp(buf, "-1.234e5") == 0);
 
     cout << "Short buffer test:" << endl;
     ftoaSciExp(buf, sizeof(buf), &exp, value, digits);
     cout << "Result: " << buf << endl << endl;
+    assert(strcmp(buf, "-1.234e5") == 0);
+}
+
+void test_itoaDec() {
+    char buf[16];
+    uint8_t n;
+
+    cout << "itoaDec():" << endl << endl;
+
+    n = itoaDec(buf, sizeof(buf), 0);
+    cout << "0: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "0") == 0 && n == 1);
+    n = itoaDec(buf, sizeof(buf), 7, 3);
+    cout << "7 width 3: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "007") == 0 && n == 3);
+    n = itoaDec(buf, sizeof(buf), -1234567);
+    cout << "-1234567: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "-1234567") == 0 && n == 8);
+    n = itoaDec(buf, sizeof(buf), INT32_MIN);
+    cout << "INT32_MIN: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "-2147483648") == 0 && n == 11);
+    n = utoaDec(buf, sizeof(buf), UINT32_MAX);
+    cout << "UINT32_MAX: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "4294967295") == 0 && n == 10);
+
+    cout << "Short buffer test:" << endl;
+    n = itoaDec(buf, 4, -1234);
+    cout << "Result: " << buf << " (" << (int)n << ")" << endl << endl;
+    assert(strcmp(buf, "Off") == 0 && n == 0);
+}
+
+void test_itoaFix() {
+    char buf[16];
+    uint8_t n;
+
+    cout << "itoaFix():" << endl << endl;
+
+    n = itoaFix(buf, sizeof(buf), 12345, 2);
+    cout << "12345, 2 decimals: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "123.45") == 0 && n == 6);
+    n = itoaFix(buf, sizeof(buf), -5, 3);
+    cout << "-5, 3 decimals: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "-0.005") == 0 && n == 6);
+    n = itoaFix(buf, sizeof(buf), 42, 0);
+    cout << "42, 0 decimals: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "42") == 0 && n == 2);
+
+    cout << "Short buffer test:" << endl;
+    n = itoaFix(buf, 6, 12345, 2);
+    cout << "Result: " << buf << " (" << (int)n << ")" << endl << endl;
+    assert(strcmp(buf, "OffLi") == 0 && n == 0);
+}
+
+/*
+ * Cases where the sprintf versions of the ftoa functions are the reference:
+ * they truncate instead of rounding, so there is never a carry into the next
+ * digit, and the strings are the same. Only the buffer checks differ: ftoaFix
+ * fails when the string would not fit, where sprintf wrote past the buffer.
+ */
+void test_ftoaLimits() {
+    char buf[24];
+    int8_t exp;
+    uint8_t n;
+
+    cout << "ftoa limits:" << endl << endl;
+
+    n = ftoaFix(buf, sizeof(buf), 9.995f, 2);
+    cout << "9.995, 2 decimals: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "9.99") == 0 && n == 4);
+    n = ftoaFix(buf, sizeof(buf), 99.999f, 0);
+    cout << "99.999, 0 decimals: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "99.0") == 0 && n == 4);
+    n = ftoaFix(buf, sizeof(buf), -0.005f, 4);
+    cout << "-0.005, 4 decimals: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "-0.0050") == 0 && n == 7);
+    ftoaEng(buf, sizeof(buf), &exp, 999.99f, 3);
+    cout << "999.99, 3 digits: " << buf << 'E' << (int)exp << endl;
+    assert(strcmp(buf, "999") == 0 && exp == 0);
+    ftoaSci(buf, sizeof(buf), &exp, 999.99f, 3);
+    cout << "999.99, 3 digits: " << buf << 'E' << (int)exp << endl;
+    assert(strcmp(buf, "9.99") == 0 && exp == 2);
+    ftoaSciExp(buf, sizeof(buf), &exp, -0.0099999f, 3);
+    cout << "-0.0099999, 3 digits: " << buf << endl;
+    assert(strcmp(buf, "-9.99e-3") == 0);
+
+    cout << "Buffer size test:" << endl;
+    // 15 chars and the terminator fit exactly in 16 bytes
+    n = ftoaFix(buf, 16, 1e9f, 4);
+    cout << "1e9, 4 decimals, 16 bytes: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "1000000000.0000") == 0 && n == 15);
+    n = ftoaFix(buf, 15, 1e9f, 4);
+    cout << "1e9, 4 decimals, 15 bytes: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "OffLimits") == 0 && n == 0);
+    n = ftoaFix(buf, 16, -1e9f, 4);
+    cout << "-1e9, 4 decimals, 16 bytes: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "OffLimits") == 0 && n == 0);
+    n = ftoaFix(buf, 17, -1e9f, 4);
+    cout << "-1e9, 4 decimals, 17 bytes: " << buf << " (" << (int)n << ")" << endl;
+    assert(strcmp(buf, "-1000000000.0000") == 0 && n == 16);
+    n = ftoaFix(buf, 8, 9.995f, 6);
+    cout << "9.995, 6 decimals, 8 bytes: " << buf << " (" << (int)n << ")" << endl << endl;
+    assert(strcmp(buf, "OffLimi") == 0 && n == 0);
 }
 
 int main(int argc, char** argv) {
-    // test_ftoaEng();
-    // test_ftoaEngExp();
-    // test_ftoaFix();
-    // test_ftoaSci();
+    test_ftoaEng();
+    test_ftoaEngExp();
+    test_ftoaFix();
+    test_ftoaSci();
     test_ftoaSciExp();
+    test_itoaDec();
+    test_itoaFix();
+    test_ftoaLimits();
 
     // TODO: check how they behave for special cases as 0.0 and off limits
     return 0;
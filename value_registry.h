@@ -0,0 +1,179 @@
+/*
+ * File:   value_registry.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:41
+ */
+
+#ifndef VALUE_REGISTRY_H
+#define VALUE_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "menu_factory.h"
+#include "menu_item.h"
+#include "menu_section.h"
+#include "value_store.h"
+
+//=============================================================================
+// ValueRegistry
+//=============================================================================
+
+/** Variable wrapped by the items with a value ID. */
+struct ValueEntry {
+    void* address;
+    uint16_t id;
+    MenuItemType type;
+};
+
+/**
+ * Constant table of the variables of the menu by value ID, defined together
+ * with the sections, e.g. in a constant array. It allows loading and saving
+ * all of them at once without creating any section, e.g. on startup.
+ *
+ * Variables restored while their items are alive are not shown until the
+ * items are refreshed, see EndpointMenuItem::invalidateValueString(), so it's
+ * best done before creating the controller.
+ *
+ * The table repeats what the item declarations say, so check() should be used
+ * to find any mismatch, e.g. on startup.
+ */
+class ValueRegistry {
+    const ValueEntry* entries_;
+    uint8_t count_;
+
+    static uint8_t sizeOf(const ValueEntry& entry) { return menuItemValueSize(entry.type); }
+public:
+    template<size_t N>
+    constexpr ValueRegistry(const ValueEntry (&entries)[N])
+        : entries_(entries), count_(N) {
+        static_assert(N <= UINT8_MAX, "too many values for a registry");
+    }
+    uint8_t getCount() const { return count_; }
+    const ValueEntry& get(uint8_t i) const { return entries_[i]; }
+    /** Entry of the value ID, or NULL if it is not registered */
+    const ValueEntry* find(uint16_t id) const {
+        for (uint8_t i = 0; i < count_; i++) {
+            if (entries_[i].id == id)
+                return &entries_[i];
+        }
+        return NULL;
+    }
+    /**
+     * Load every variable from the store, the ones never stored are left as
+     * they are.
+     * @return number of variables loaded
+     */
+    uint8_t restore(ValueStore& store) const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < count_; i++) {
+            if (store.get(entries_[i].id, entries_[i].address, sizeOf(entries_[i])))
+                n++;
+        }
+        return n;
+    }
+    /** Put every variable in the store, which writes the ones changed on flush */
+    void save(ValueStore& store) const {
+        for (uint8_t i = 0; i < count_; i++)
+            store.put(entries_[i].id, entries_[i].address, sizeOf(entries_[i]));
+    }
+
+    /**
+     * Whether the items of the section agree with the table: the items with a
+     * registered value ID must wrap its variable and be of its type, and the
+     * items wrapping a registered variable must have its value ID.
+     */
+    bool check(BaseMenuSection* section) const {
+        AbstractMenuItem** items = section->getItems();
+        for (uint8_t i = 0; i < section->getSize(); i++) {
+            if (items[i]->isSection())
+                continue;
+            const EndpointMenuItem* item = (const EndpointMenuItem*)items[i];
+            for (uint8_t j = 0; j < count_; j++) {
+                bool same_id = entries_[j].id == item->getValueStorageId();
+                bool same_address = entries_[j].address == item->getValuePointer();
+                if (same_id != same_address
+                        || (same_id && entries_[j].type != item->getType()))
+                    return false;
+            }
+        }
+        return true;
+    }
+    /**
+     * check() every section with an ID below count, e.g. the section_count of
+     * a StaticMenu. Each of them is created and destroyed in turn, so the
+     * factory must have a free slot, e.g. before creating the controller.
+     * @return false if a section does not agree or could not be created
+     */
+    bool check(MenuFactory& menu, uint16_t count) const {
+        for (uint16_t id = 0; id < count; id++) {
+            BaseMenuSection* section = menu.createSection(id);
+            if (!section)
+                return false;
+            bool valid = check(section);
+            menu.destroySection(section);
+            if (!valid)
+                return false;
+        }
+        return true;
+    }
+
+    //========== Snapshots ===========
+
+    /**
+     * Signature of the layout of the table, so that snapshots taken with a
+     * different one are rejected.
+     */
+    uint16_t getSignature() const {
+        uint16_t sig = count_;
+        for (uint8_t i = 0; i < count_; i++)
+            sig = (sig << 5 | sig >> 11) ^ (entries_[i].id << 4 | (uint8_t)entries_[i].type);
+        return sig;
+    }
+    /** Bytes needed by a snapshot: the signature and every value packed */
+    size_t getSnapshotSize() const {
+        size_t size = sizeof(uint16_t);
+        for (uint8_t i = 0; i < count_; i++)
+            size += sizeOf(entries_[i]);
+        return size;
+    }
+    /**
+     * Copy every variable into buf, in the order of the table.
+     * @return bytes written, or 0 if buf is too small
+     */
+    size_t snapshot(void* buf, size_t size) const {
+        if (size < getSnapshotSize())
+            return 0;
+        uint8_t* p = (uint8_t*)buf;
+        uint16_t sig = getSignature();
+        memcpy(p, &sig, sizeof(sig));
+        p += sizeof(sig);
+        for (uint8_t i = 0; i < count_; i++) {
+            memcpy(p, entries_[i].address, sizeOf(entries_[i]));
+            p += sizeOf(entries_[i]);
+        }
+        return p - (uint8_t*)buf;
+    }
+    /**
+     * Set every variable from a snapshot. Nothing is changed if its size or
+     * signature do not match the table.
+     */
+    bool restoreSnapshot(const void* buf, size_t size) const {
+        const uint8_t* p = (const uint8_t*)buf;
+        uint16_t sig;
+        if (size != getSnapshotSize())
+            return false;
+        memcpy(&sig, p, sizeof(sig));
+        if (sig != getSignature())
+            return false;
+        p += sizeof(sig);
+        for (uint8_t i = 0; i < count_; i++) {
+            memcpy(entries_[i].address, p, sizeOf(entries_[i]));
+            p += sizeOf(entries_[i]);
+        }
+        return true;
+    }
+};
+
+#endif /* VALUE_REGISTRY_H */
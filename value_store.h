@@ -0,0 +1,269 @@
+/*
+ * File:   value_store.h
+ * Author: agent
+ *
+ * Created on 17 de octubre de 2026, 00:40
+ */
+
+#ifndef VALUE_STORE_H
+#define VALUE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "menu_item.h"
+
+/**
+ * Max number of different values kept by a ValueStore. Value IDs must be below
+ * it, and the EEPROM must have room for more records than this, see
+ * ValueStore::hasRoom().
+ */
+#ifndef MAX_VALUE_STORE_IDS
+#define MAX_VALUE_STORE_IDS 32
+#endif
+
+/** Number of values whose writes can be held by a ValueStore before a flush */
+#ifndef VALUE_STORE_PENDING
+#define VALUE_STORE_PENDING 8
+#endif
+
+//=============================================================================
+// EepromDevice
+//=============================================================================
+
+/**
+ * Byte-addressable non-volatile memory, e.g. the EEPROM of the AVR, or a file
+ * emulating it when testing on the PC.
+ */
+class EepromDevice {
+public:
+    virtual ~EepromDevice() = 0;
+    /** Size in bytes */
+    virtual size_t getSize() const = 0;
+    virtual void read(size_t addr, void* buf, size_t sz) = 0;
+    virtual void write(size_t addr, const void* buf, size_t sz) = 0;
+};
+inline EepromDevice::~EepromDevice() { }
+
+//=============================================================================
+// ValueStore
+//=============================================================================
+
+/**
+ * Persistent storage of the values edited in the menu, by their value ID.
+ *
+ * Writes are combined in RAM: put() only keeps the latest value of each ID,
+ * and flush() writes them all, skipping the ones equal to what is stored. This
+ * way a value edited many times costs a single EEPROM write. When to flush is
+ * up to the application: explicitly, once a number of values are pending, see
+ * setFlushThreshold(), or once they have been pending for a while, see
+ * setFlushDelay() and poll(). The MenuController also flushes when leaving a
+ * section, either up or down a level, committing a transaction and on destruction.
+ *
+ * The EEPROM is used as a circular journal of fixed-size records, each with
+ * the ID, a sequence number and a checksum. A new record goes to the next slot
+ * that does not hold the latest record of a value, so the cells of the values
+ * changed wear at the same rate, and the ones of values rarely changed are
+ * skipped until they are. As the latest record of a value is never
+ * overwritten, a write interrupted by a power loss loses at most the value
+ * being written, which keeps its previous one. On startup, begin() scans the
+ * journal for the latest valid record of each ID.
+ */
+class ValueStore {
+    struct Record {
+        uint16_t id;
+        uint32_t seq; // wide enough to never wrap while the EEPROM lasts
+        uint8_t data[MAX_MENU_ITEM_VALUE_BYTES];
+        uint8_t checksum;
+    };
+    struct Pending {
+        uint16_t id;
+        uint8_t size;
+        uint8_t data[MAX_MENU_ITEM_VALUE_BYTES];
+    };
+    static const uint16_t NONE = UINT16_MAX;
+
+    EepromDevice& eeprom_;
+    const uint16_t slots_;
+    uint16_t latest_[MAX_VALUE_STORE_IDS]; // slot of the newest record of each ID
+    uint16_t head_{0}; // next slot to write
+    uint32_t seq_{0}; // sequence number of the next record
+    Pending pending_[VALUE_STORE_PENDING];
+    uint8_t pending_count_{0};
+    uint8_t flush_threshold_{VALUE_STORE_PENDING};
+    uint32_t flush_delay_{0};
+    uint32_t pending_since_{0};
+    bool pending_seen_{false}; // pending_since_ is set
+    uint32_t records_written_{0};
+
+    static uint8_t checksum(const Record& rec) {
+        const uint8_t* p = (const uint8_t*)&rec;
+        uint8_t sum = 0;
+        for (size_t i = 0; i < offsetof(Record, checksum); i++)
+            sum += p[i];
+        return ~sum;
+    }
+    static size_t slotAddr(uint16_t slot) { return slot * sizeof(Record); }
+    bool readSlot(uint16_t slot, Record& rec) {
+        eeprom_.read(slotAddr(slot), &rec, sizeof(rec));
+        return rec.id < MAX_VALUE_STORE_IDS && rec.checksum == checksum(rec);
+    }
+    /** Whether the slot holds the latest record of some value */
+    bool isLive(uint16_t slot) const {
+        for (uint16_t i = 0; i < MAX_VALUE_STORE_IDS; i++) {
+            if (latest_[i] == slot)
+                return true;
+        }
+        return false;
+    }
+    void append(uint16_t id, const uint8_t* data) {
+        // skip the latest records, including the one of this value, so that
+        // they survive if the write is interrupted. There is always a free
+        // slot as long as hasRoom()
+        for (uint16_t n = 0; n < slots_ && isLive(head_); n++)
+            head_ = head_ + 1 == slots_ ? 0 : head_ + 1;
+        Record rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.id = id;
+        rec.seq = seq_++;
+        memcpy(rec.data, data, sizeof(rec.data));
+        rec.checksum = checksum(rec);
+        eeprom_.write(slotAddr(head_), &rec, sizeof(rec));
+        latest_[id] = head_;
+        head_ = head_ + 1 == slots_ ? 0 : head_ + 1;
+        records_written_++;
+    }
+public:
+    /**
+     * @param eeprom where to keep the journal, all of it. It must have more
+     * slots than MAX_VALUE_STORE_IDS, otherwise nothing is stored, see
+     * hasRoom().
+     */
+    ValueStore(EepromDevice& eeprom)
+        : eeprom_(eeprom), slots_(eeprom.getSize() / sizeof(Record)) {
+        for (uint16_t i = 0; i < MAX_VALUE_STORE_IDS; i++)
+            latest_[i] = NONE;
+    }
+    /**
+     * Whether the EEPROM is big enough for the journal, i.e. there is always
+     * a slot not holding the latest record of any value.
+     */
+    bool hasRoom() const { return slots_ > MAX_VALUE_STORE_IDS; }
+    /**
+     * Scan the journal for the latest records. To be called once on startup,
+     * before get().
+     */
+    void begin() {
+        bool any = false;
+        uint32_t newest = 0;
+        Record rec;
+        for (uint16_t slot = 0; slot < slots_; slot++) {
+            if (!readSlot(slot, rec))
+                continue;
+            Record cur;
+            if (latest_[rec.id] == NONE || (readSlot(latest_[rec.id], cur)
+                    && rec.seq > cur.seq))
+                latest_[rec.id] = slot;
+            if (!any || rec.seq > newest) {
+                newest = rec.seq;
+                head_ = slot + 1 == slots_ ? 0 : slot + 1;
+                any = true;
+            }
+        }
+        seq_ = any ? newest + 1 : 0;
+    }
+    /**
+     * Keep a new value to be written on the next flush. If there were
+     * already a value pending with that ID, it is replaced. If there is no room
+     * for it, the pending values are flushed first, and once the flush
+     * threshold is reached, all of them are.
+     * @return false if the ID or size are not supported, or the EEPROM is too
+     * small
+     */
+    bool put(uint16_t id, const void* data, uint8_t size) {
+        if (id >= MAX_VALUE_STORE_IDS || size > MAX_MENU_ITEM_VALUE_BYTES || !hasRoom())
+            return false;
+        uint8_t i = 0;
+        while (i < pending_count_ && pending_[i].id != id)
+            i++;
+        if (i == VALUE_STORE_PENDING) {
+            flush();
+            i = 0;
+        }
+        if (i == pending_count_)
+            pending_count_++;
+        pending_[i].id = id;
+        pending_[i].size = size;
+        memset(pending_[i].data, 0, sizeof(pending_[i].data));
+        memcpy(pending_[i].data, data, size);
+        if (pending_count_ >= flush_threshold_)
+            flush();
+        return true;
+    }
+    /**
+     * Get the latest value of an ID, pending or stored.
+     * @return false if it was never stored
+     */
+    bool get(uint16_t id, void* data, uint8_t size) {
+        if (id >= MAX_VALUE_STORE_IDS || size > MAX_MENU_ITEM_VALUE_BYTES)
+            return false;
+        for (uint8_t i = 0; i < pending_count_; i++) {
+            if (pending_[i].id == id) {
+                memcpy(data, pending_[i].data, size);
+                return true;
+            }
+        }
+        Record rec;
+        if (latest_[id] == NONE || !readSlot(latest_[id], rec))
+            return false;
+        memcpy(data, rec.data, size);
+        return true;
+    }
+    /** Write the pending values that differ from the stored ones */
+    void flush() {
+        Record rec;
+        for (uint8_t i = 0; i < pending_count_; i++) {
+            const Pending& p = pending_[i];
+            if (latest_[p.id] != NONE && readSlot(latest_[p.id], rec)
+                    && memcmp(rec.data, p.data, sizeof(rec.data)) == 0)
+                continue;
+            append(p.id, p.data);
+        }
+        pending_count_ = 0;
+        pending_seen_ = false;
+    }
+    /**
+     * Flush as soon as n values are pending, 1 writing every value put at
+     * once. By default it is VALUE_STORE_PENDING, i.e. only when there is no
+     * room for more.
+     */
+    void setFlushThreshold(uint8_t n) {
+        flush_threshold_ = n == 0 ? 1 : n < VALUE_STORE_PENDING ? n : VALUE_STORE_PENDING;
+    }
+    /**
+     * Make poll() flush the values pending for at least delay, e.g. in ms,
+     * or never if 0, which is the default.
+     */
+    void setFlushDelay(uint32_t delay) { flush_delay_ = delay; }
+    /**
+     * Flush if values have been pending for the flush delay, counted from the
+     * first call that found them. To be called periodically by the
+     * application, e.g. from its main loop.
+     * @param now current time, in the units of the delay
+     */
+    void poll(uint32_t now) {
+        if (pending_count_ == 0 || flush_delay_ == 0)
+            return;
+        if (!pending_seen_) {
+            pending_since_ = now;
+            pending_seen_ = true;
+        } else if (now - pending_since_ >= flush_delay_) {
+            flush();
+        }
+    }
+    uint8_t getPendingCount() const { return pending_count_; }
+    /** Number of records written to the EEPROM */
+    uint32_t getRecordsWritten() const { return records_written_; }
+};
+
+#endif /* VALUE_STORE_H */